@@ -0,0 +1,303 @@
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/LatencyHistogram.hpp"
+
+// Fixed-duration throughput harness shared by the benchmark suite.
+//
+// A trial builds a fresh structure, starts the worker threads behind a start
+// flag, lets them run for the configured duration and divides the operations
+// they report by the wall time between start and stop. Every configuration
+// runs a number of untimed warmup trials and then a number of measured
+// repetitions, from which the mean ops/sec and a 95% confidence interval
+// (Student's t) are reported.
+//
+// In latency mode the suite instead offers messages at a fixed rate and
+// reports the enqueue-to-dequeue latency distribution of each structure.
+
+struct BenchConfig {
+    bool latency = false;
+    double rate = 100000;
+    size_t producers = 1;
+    size_t consumers = 1;
+    std::vector<size_t> threads;
+    size_t warmup = 1;
+    size_t repetitions = 5;
+    std::chrono::milliseconds duration{200};
+    std::string filter;
+    std::string csvPath;
+    std::string jsonPath;
+};
+
+struct BenchResult {
+    std::string structure;
+    std::string implementation;
+    std::string workload;
+    size_t threads = 0;
+    size_t capacity = 0;
+    std::vector<double> samples;
+    double mean = 0;
+    double stddev = 0;
+    double ciLow = 0;
+    double ciHigh = 0;
+};
+
+struct LatencyResult {
+    std::string structure;
+    std::string implementation;
+    size_t producers = 0;
+    size_t consumers = 0;
+    size_t capacity = 0;
+    double offeredRate = 0;
+    double achievedRate = 0;
+    uint64_t count = 0;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+};
+
+// Runs body(threadIndex, stop) on numThreads threads for duration. Each body
+// loops until stop is set and returns the number of operations it completed.
+// Returns total operations per second.
+inline double runThreads(size_t numThreads, std::chrono::milliseconds duration,
+                         const std::function<uint64_t(size_t, const std::atomic<bool>&)>& body) {
+    std::atomic<bool> go{false};
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> ready{0};
+    std::vector<uint64_t> counts(numThreads, 0);
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&, i]() {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            counts[i] = body(i, stop);
+        });
+    }
+    while (ready.load() != numThreads) {
+        std::this_thread::yield();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(duration);
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : threads) {
+        t.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    uint64_t total = 0;
+    for (uint64_t count : counts) {
+        total += count;
+    }
+    return static_cast<double>(total) / elapsed.count();
+}
+
+// Two-sided 97.5% quantile of Student's t distribution.
+inline double studentT975(size_t degrees) {
+    static const double table[] = {12.706, 4.303, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201,
+                                   2.179,  2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086, 2.080,
+                                   2.074,  2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042, 2.042};
+    if (degrees == 0) {
+        return 0;
+    }
+    return degrees <= 30 ? table[degrees - 1] : 1.960;
+}
+
+class BenchSuite {
+public:
+    explicit BenchSuite(BenchConfig cfg) : config(std::move(cfg)) {}
+
+    const BenchConfig& settings() const { return config; }
+
+    // filter is a comma-separated list of structure names.
+    bool selected(const std::string& structure) const {
+        if (config.filter.empty()) {
+            return true;
+        }
+        return ("," + config.filter + ",").find("," + structure + ",") != std::string::npos;
+    }
+
+    // trial(threads) builds a fresh structure, runs it and returns ops/sec.
+    void measure(const std::string& structure, const std::string& implementation, const std::string& workload,
+                 size_t threads, size_t capacity, const std::function<double(size_t)>& trial) {
+        BenchResult result;
+        result.structure = structure;
+        result.implementation = implementation;
+        result.workload = workload;
+        result.threads = threads;
+        result.capacity = capacity;
+
+        for (size_t i = 0; i < config.warmup; ++i) {
+            trial(threads);
+        }
+        for (size_t i = 0; i < config.repetitions; ++i) {
+            result.samples.push_back(trial(threads));
+        }
+        summarize(result);
+        print(result);
+        results.push_back(std::move(result));
+    }
+
+    // Summarizes a merged latency histogram (in nanoseconds) for one run.
+    void recordLatency(const std::string& structure, const std::string& implementation, size_t capacity,
+                       const LatencyHistogram& histogram, double seconds) {
+        LatencyResult result;
+        result.structure = structure;
+        result.implementation = implementation;
+        result.producers = config.producers;
+        result.consumers = config.consumers;
+        result.capacity = capacity;
+        result.offeredRate = config.rate;
+        result.count = histogram.Count();
+        result.achievedRate = static_cast<double>(result.count) / seconds;
+        result.p50 = histogram.Percentile(0.50);
+        result.p90 = histogram.Percentile(0.90);
+        result.p99 = histogram.Percentile(0.99);
+        result.p999 = histogram.Percentile(0.999);
+        result.max = histogram.Max();
+
+        std::ostringstream line;
+        line << std::left << std::setw(14) << structure << std::setw(30) << implementation << std::right
+             << std::fixed << std::setprecision(0) << std::setw(9) << result.achievedRate << " msg/s  p50 "
+             << std::setw(8) << result.p50 << "  p90 " << std::setw(8) << result.p90 << "  p99 " << std::setw(9)
+             << result.p99 << "  p99.9 " << std::setw(9) << result.p999 << "  max " << std::setw(10) << result.max
+             << " ns";
+        std::cout << line.str() << std::endl;
+        latencyResults.push_back(result);
+    }
+
+    // Writes the requested CSV/JSON files. Returns false if one could not be
+    // opened.
+    bool write() const {
+        bool ok = true;
+        if (!config.csvPath.empty()) {
+            std::ofstream out(config.csvPath);
+            ok = ok && static_cast<bool>(out);
+            if (latencyResults.empty()) {
+                writeCsv(out);
+            } else {
+                writeLatencyCsv(out);
+            }
+        }
+        if (!config.jsonPath.empty()) {
+            std::ofstream out(config.jsonPath);
+            ok = ok && static_cast<bool>(out);
+            if (latencyResults.empty()) {
+                writeJson(out);
+            } else {
+                writeLatencyJson(out);
+            }
+        }
+        return ok;
+    }
+
+private:
+    static void summarize(BenchResult& result) {
+        const size_t n = result.samples.size();
+        if (n == 0) {
+            return;
+        }
+        double sum = 0;
+        for (double sample : result.samples) {
+            sum += sample;
+        }
+        result.mean = sum / static_cast<double>(n);
+        double squares = 0;
+        for (double sample : result.samples) {
+            squares += (sample - result.mean) * (sample - result.mean);
+        }
+        result.stddev = n > 1 ? std::sqrt(squares / static_cast<double>(n - 1)) : 0;
+        const double half = studentT975(n - 1) * result.stddev / std::sqrt(static_cast<double>(n));
+        result.ciLow = result.mean - half;
+        result.ciHigh = result.mean + half;
+    }
+
+    static void print(const BenchResult& result) {
+        std::ostringstream line;
+        line << std::left << std::setw(14) << result.structure << std::setw(30) << result.implementation
+             << std::setw(12) << result.workload << std::right << " threads " << std::setw(3) << result.threads
+             << "  capacity " << std::setw(7) << result.capacity << "  " << std::fixed << std::setprecision(3)
+             << std::setw(10) << result.mean / 1e6 << " Mops/s  +/- " << (result.ciHigh - result.mean) / 1e6;
+        std::cout << line.str() << std::endl;
+    }
+
+    void writeCsv(std::ostream& out) const {
+        out << "structure,implementation,workload,threads,capacity,repetitions,mean_ops_per_sec,stddev,"
+               "ci95_low,ci95_high,min,max\n";
+        for (const BenchResult& r : results) {
+            const auto [low, high] = std::minmax_element(r.samples.begin(), r.samples.end());
+            out << r.structure << ',' << r.implementation << ',' << r.workload << ',' << r.threads << ','
+                << r.capacity << ',' << r.samples.size() << ',' << std::fixed << std::setprecision(1) << r.mean
+                << ',' << r.stddev << ',' << r.ciLow << ',' << r.ciHigh << ',' << *low << ',' << *high << '\n';
+        }
+    }
+
+    void writeJson(std::ostream& out) const {
+        out << "{\n  \"duration_ms\": " << config.duration.count() << ",\n  \"warmup\": " << config.warmup
+            << ",\n  \"results\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            out << (i == 0 ? "\n" : ",\n") << "    {\"structure\": \"" << r.structure << "\", \"implementation\": \""
+                << r.implementation << "\", \"workload\": \"" << r.workload << "\", \"threads\": " << r.threads
+                << ", \"capacity\": " << r.capacity << ", \"mean_ops_per_sec\": " << std::fixed
+                << std::setprecision(1) << r.mean << ", \"stddev\": " << r.stddev << ", \"ci95\": [" << r.ciLow
+                << ", " << r.ciHigh << "], \"samples\": [";
+            for (size_t j = 0; j < r.samples.size(); ++j) {
+                out << (j == 0 ? "" : ", ") << r.samples[j];
+            }
+            out << "]}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    void writeLatencyCsv(std::ostream& out) const {
+        out << "structure,implementation,producers,consumers,capacity,offered_rate,achieved_rate,count,"
+               "p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n";
+        for (const LatencyResult& r : latencyResults) {
+            out << r.structure << ',' << r.implementation << ',' << r.producers << ',' << r.consumers << ','
+                << r.capacity << ',' << std::fixed << std::setprecision(1) << r.offeredRate << ',' << r.achievedRate
+                << ',' << r.count << ',' << r.p50 << ',' << r.p90 << ',' << r.p99 << ',' << r.p999 << ',' << r.max
+                << '\n';
+        }
+    }
+
+    void writeLatencyJson(std::ostream& out) const {
+        out << "{\n  \"duration_ms\": " << config.duration.count() << ",\n  \"latency\": [";
+        for (size_t i = 0; i < latencyResults.size(); ++i) {
+            const LatencyResult& r = latencyResults[i];
+            out << (i == 0 ? "\n" : ",\n") << "    {\"structure\": \"" << r.structure << "\", \"implementation\": \""
+                << r.implementation << "\", \"producers\": " << r.producers << ", \"consumers\": " << r.consumers
+                << ", \"capacity\": " << r.capacity << ", \"offered_rate\": " << std::fixed << std::setprecision(1)
+                << r.offeredRate << ", \"achieved_rate\": " << r.achievedRate << ", \"count\": " << r.count
+                << ", \"p50_ns\": " << r.p50 << ", \"p90_ns\": " << r.p90 << ", \"p99_ns\": " << r.p99
+                << ", \"p999_ns\": " << r.p999 << ", \"max_ns\": " << r.max << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    BenchConfig config;
+    std::vector<BenchResult> results;
+    std::vector<LatencyResult> latencyResults;
+};
+
+#endif
@@ -0,0 +1,526 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include "Harness.hpp"
+#include "../include/Queue.hpp"
+#include "../include/Priority_Queue.hpp"
+#include "../include/RingBuffer.hpp"
+#include "../include/MultiQueue.hpp"
+#include "../include/LockBasedLinkedList.hpp"
+#include "../include/LockFreeLinkedList.hpp"
+#include "../include/LockFreeSkipList.hpp"
+#include "../include/LockFreeHashMap.hpp"
+#include "../include/LatencyHistogram.hpp"
+#include "../include/Backoff.hpp"
+
+
+// Lock-based baselines not already in include/.
+class MutexPriorityQueue {
+public:
+    bool Push(uint64_t value, size_t priority) {
+        std::lock_guard<std::mutex> lock(mutex);
+        heap.emplace(priority, value);
+        return true;
+    }
+
+    bool Pop(uint64_t& value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (heap.empty()) {
+            return false;
+        }
+        value = heap.top().second;
+        heap.pop();
+        return true;
+    }
+
+private:
+    std::priority_queue<std::pair<size_t, uint64_t>> heap;
+    std::mutex mutex;
+};
+
+template <typename Container>
+class MutexSet {
+public:
+    bool insert(int k, void*) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return set.insert(k).second;
+    }
+
+    bool deleteNode(int k) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return set.erase(k) == 1;
+    }
+
+    bool search(int k) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return set.find(k) != set.end();
+    }
+
+private:
+    Container set;
+    std::mutex mutex;
+};
+
+class MutexHashMap {
+public:
+    bool insert(int k, void* value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return map.emplace(k, value).second;
+    }
+
+    bool deleteNode(int k) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return map.erase(k) == 1;
+    }
+
+    bool search(int k) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return map.find(k) != map.end();
+    }
+
+private:
+    std::unordered_map<int, void*> map;
+    std::mutex mutex;
+};
+
+const size_t BATCH = 64;
+
+// Every thread alternates a push and a pop on a queue prefilled to half its
+// capacity. Each push and each pop that succeeds counts as one operation; a
+// push that finds the queue full or a pop that finds it empty does not.
+template <typename Make, typename Push, typename Pop>
+void benchPushPop(BenchSuite& suite, const std::string& structure, const std::string& implementation,
+                  size_t capacity, size_t prefill, Make make, Push push, Pop pop) {
+    for (size_t threads : suite.settings().threads) {
+        suite.measure(structure, implementation, "push-pop", threads, capacity, [&](size_t numThreads) {
+            auto queue = make();
+            for (size_t i = 0; i < prefill; ++i) {
+                push(*queue, i);
+            }
+            return runThreads(numThreads, suite.settings().duration,
+                              [&](size_t index, const std::atomic<bool>& stop) {
+                                  uint64_t ops = 0;
+                                  uint64_t value = index << 40;
+                                  uint64_t out;
+                                  while (!stop.load(std::memory_order_relaxed)) {
+                                      for (size_t i = 0; i < BATCH; ++i) {
+                                          if (push(*queue, value++)) {
+                                              ++ops;
+                                          }
+                                          if (pop(*queue, out)) {
+                                              ++ops;
+                                          }
+                                      }
+                                  }
+                                  return ops;
+                              });
+        });
+    }
+}
+
+// One producer and one consumer; counts elements handed over.
+template <typename Make, typename Push, typename Pop>
+void benchSpsc(BenchSuite& suite, const std::string& implementation, size_t capacity, Make make, Push push,
+               Pop pop) {
+    suite.measure("spsc", implementation, "transfer", 2, capacity, [&](size_t) {
+        auto queue = make();
+        return runThreads(2, suite.settings().duration, [&](size_t index, const std::atomic<bool>& stop) {
+            uint64_t ops = 0;
+            uint64_t value = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (size_t i = 0; i < BATCH; ++i) {
+                    if (index == 0 ? push(*queue, value) : pop(*queue, value)) {
+                        ++ops;
+                    }
+                }
+            }
+            return index == 0 ? 0 : ops;
+        });
+    });
+}
+
+// 80% search, 10% insert, 10% delete over a half-full key range.
+template <typename SetType>
+void benchSet(BenchSuite& suite, const std::string& structure, const std::string& implementation, int keyRange) {
+    for (size_t threads : suite.settings().threads) {
+        suite.measure(structure, implementation, "80/10/10", threads, static_cast<size_t>(keyRange),
+                      [&](size_t numThreads) {
+                          auto set = std::make_unique<SetType>();
+                          // Descending, so sorted lists insert at the head.
+                          for (int key = keyRange - 2; key >= 0; key -= 2) {
+                              set->insert(key, nullptr);
+                          }
+                          return runThreads(numThreads, suite.settings().duration,
+                                            [&](size_t index, const std::atomic<bool>& stop) {
+                                                uint64_t ops = 0;
+                                                unsigned seed = static_cast<unsigned>(index) * 2654435761U + 1U;
+                                                while (!stop.load(std::memory_order_relaxed)) {
+                                                    for (size_t i = 0; i < BATCH; ++i) {
+                                                        seed = seed * 1103515245U + 12345U;
+                                                        const int key = static_cast<int>((seed >> 8) % keyRange);
+                                                        const unsigned op = (seed >> 24) % 100U;
+                                                        if (op < 80U) {
+                                                            set->search(key);
+                                                        } else if (op < 90U) {
+                                                            set->insert(key, nullptr);
+                                                        } else {
+                                                            set->deleteNode(key);
+                                                        }
+                                                    }
+                                                    ops += BATCH;
+                                                }
+                                                return ops;
+                                            });
+                      });
+    }
+}
+
+// Offered-load latency. Producers send at a fixed aggregate rate and stamp
+// each message with the time it was due to be sent, not the time it went
+// out, so waiting for a full queue or a descheduled producer still counts
+// (no coordinated omission). Each consumer records now - stamp into its own
+// histogram; they are merged at the end.
+template <typename Make, typename Push, typename Pop>
+void benchLatency(BenchSuite& suite, const std::string& structure, const std::string& implementation,
+                  size_t capacity, size_t producers, size_t consumers, Make make, Push push, Pop pop) {
+    auto queue = make();
+    const auto origin = std::chrono::steady_clock::now();
+    auto now = [origin] {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count());
+    };
+    const double interval = 1e9 * static_cast<double>(producers) / suite.settings().rate;
+    const uint64_t start = now() + 1000000;
+    const uint64_t end = start + static_cast<uint64_t>(
+                                     std::chrono::duration_cast<std::chrono::nanoseconds>(suite.settings().duration).count());
+
+    std::atomic<size_t> producersLeft{producers};
+    std::vector<std::unique_ptr<LatencyHistogram>> histograms;
+    for (size_t i = 0; i < consumers; ++i) {
+        histograms.push_back(std::make_unique<LatencyHistogram>());
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            // Producers are staggered evenly across one interval.
+            const double offset = interval * static_cast<double>(p) / static_cast<double>(producers);
+            for (uint64_t i = 0;; ++i) {
+                const uint64_t due = start + static_cast<uint64_t>(offset + interval * static_cast<double>(i));
+                if (due >= end) {
+                    break;
+                }
+                for (uint64_t t = now(); t < due; t = now()) {
+                    if (due - t > 20000) {
+                        std::this_thread::yield();
+                    } else {
+                        CpuRelax();
+                    }
+                }
+                while (!push(*queue, due)) {
+                    CpuRelax();
+                }
+            }
+            producersLeft.fetch_sub(1, std::memory_order_release);
+        });
+    }
+    for (size_t c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c]() {
+            LatencyHistogram& histogram = *histograms[c];
+            uint64_t stamp;
+            while (true) {
+                if (pop(*queue, stamp)) {
+                    histogram.Record(now() - stamp);
+                } else if (producersLeft.load(std::memory_order_acquire) == 0) {
+                    if (!pop(*queue, stamp)) {
+                        break;
+                    }
+                    histogram.Record(now() - stamp);
+                } else {
+                    CpuRelax();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    // An overloaded run drains past end; rate it over the time actually taken.
+    const uint64_t finish = now();
+
+    LatencyHistogram merged;
+    for (const auto& histogram : histograms) {
+        merged.Merge(*histogram);
+    }
+    suite.recordLatency(structure, implementation, capacity, merged, static_cast<double>(finish - start) / 1e9);
+}
+
+const size_t LATENCY_CAPACITY = 1024;
+const size_t LATENCY_LEVELS = 4;
+
+void runLatency(BenchSuite& suite) {
+    const size_t producers = suite.settings().producers;
+    const size_t consumers = suite.settings().consumers;
+    std::cout << "Offered load " << suite.settings().rate << " msg/s, " << producers << " producer(s), " << consumers
+              << " consumer(s), capacity " << LATENCY_CAPACITY << "..." << std::endl;
+
+    if (suite.selected("queue")) {
+        benchLatency(
+            suite, "queue", "Queue", LATENCY_CAPACITY, producers, consumers,
+            [] { return std::make_unique<Queue<uint64_t, LATENCY_CAPACITY>>(); },
+            [](auto& q, uint64_t v) { return q.Push(v); }, [](auto& q, uint64_t& v) { return q.Pop(v); });
+        benchLatency(
+            suite, "queue", "MpmcRingBuf", LATENCY_CAPACITY, producers, consumers,
+            [] { return std::make_unique<MpmcRingBuf<uint64_t, LATENCY_CAPACITY>>(); },
+            [](auto& q, uint64_t v) { return q.Write(&v, 1); }, [](auto& q, uint64_t& v) { return q.Read(&v, 1); });
+        benchLatency(
+            suite, "queue", "LockBasedBuffer", LATENCY_CAPACITY, producers, consumers,
+            [] { return std::make_unique<LockBasedBuffer<uint64_t>>(LATENCY_CAPACITY); },
+            [](auto& q, uint64_t v) { return q.Write(v); }, [](auto& q, uint64_t& v) { return q.Read(v); });
+    }
+    if (suite.selected("priority")) {
+        benchLatency(
+            suite, "priority", "PriorityQueue", LATENCY_CAPACITY, producers, consumers,
+            [] { return std::make_unique<PriorityQueue<uint64_t, LATENCY_CAPACITY, LATENCY_LEVELS>>(); },
+            [](auto& q, uint64_t v) { return q.Push(v, v % LATENCY_LEVELS); }, [](auto& q, uint64_t& v) { return q.Pop(v); });
+        benchLatency(
+            suite, "priority", "PriorityQueue<WeightedFair>", LATENCY_CAPACITY, producers, consumers,
+            [] { return std::make_unique<PriorityQueue<uint64_t, LATENCY_CAPACITY, LATENCY_LEVELS, WeightedFair<>>>(); },
+            [](auto& q, uint64_t v) { return q.Push(v, v % LATENCY_LEVELS); }, [](auto& q, uint64_t& v) { return q.Pop(v); });
+        benchLatency(
+            suite, "priority", "Mutex std::priority_queue", LATENCY_CAPACITY, producers, consumers,
+            [] { return std::make_unique<MutexPriorityQueue>(); },
+            [](auto& q, uint64_t v) { return q.Push(v, v % LATENCY_LEVELS); }, [](auto& q, uint64_t& v) { return q.Pop(v); });
+    }
+    // RingBuf is single-producer, single-consumer.
+    if (suite.selected("spsc") && producers == 1 && consumers == 1) {
+        benchLatency(
+            suite, "spsc", "RingBuf", LATENCY_CAPACITY, 1, 1, [] { return std::make_unique<RingBuf<uint64_t, LATENCY_CAPACITY>>(); },
+            [](auto& q, uint64_t v) { return q.Write(&v, 1); }, [](auto& q, uint64_t& v) { return q.Read(&v, 1); });
+    }
+}
+
+template <size_t capacity>
+void benchBoundedQueues(BenchSuite& suite) {
+    if (suite.selected("queue")) {
+        benchPushPop(
+            suite, "queue", "Queue", capacity, capacity / 2,
+            [] { return std::make_unique<Queue<uint64_t, capacity>>(); },
+            [](auto& q, uint64_t v) { return q.Push(v); }, [](auto& q, uint64_t& v) { return q.Pop(v); });
+        benchPushPop(
+            suite, "queue", "Queue<PaddedLayout>", capacity, capacity / 2,
+            [] { return std::make_unique<Queue<uint64_t, capacity, PaddedLayout>>(); },
+            [](auto& q, uint64_t v) { return q.Push(v); }, [](auto& q, uint64_t& v) { return q.Pop(v); });
+        benchPushPop(
+            suite, "queue", "MpmcRingBuf", capacity, capacity / 2,
+            [] { return std::make_unique<MpmcRingBuf<uint64_t, capacity>>(); },
+            [](auto& q, uint64_t v) { return q.Write(&v, 1); }, [](auto& q, uint64_t& v) { return q.Read(&v, 1); });
+        benchPushPop(
+            suite, "queue", "LockBasedBuffer", capacity, capacity / 2,
+            [] { return std::make_unique<LockBasedBuffer<uint64_t>>(capacity); },
+            [](auto& q, uint64_t v) { return q.Write(v); }, [](auto& q, uint64_t& v) { return q.Read(v); });
+    }
+
+    if (suite.selected("priority")) {
+        const size_t levels = 4;
+        benchPushPop(
+            suite, "priority", "PriorityQueue", capacity, capacity / 2,
+            [] { return std::make_unique<PriorityQueue<uint64_t, capacity, levels>>(); },
+            [](auto& q, uint64_t v) { return q.Push(v, v % levels); }, [](auto& q, uint64_t& v) { return q.Pop(v); });
+        benchPushPop(
+            suite, "priority", "PriorityQueue<WeightedFair>", capacity, capacity / 2,
+            [] { return std::make_unique<PriorityQueue<uint64_t, capacity, levels, WeightedFair<>>>(); },
+            [](auto& q, uint64_t v) { return q.Push(v, v % levels); }, [](auto& q, uint64_t& v) { return q.Pop(v); });
+        benchPushPop(
+            suite, "priority", "Mutex std::priority_queue", capacity, capacity / 2,
+            [] { return std::make_unique<MutexPriorityQueue>(); },
+            [](auto& q, uint64_t v) { return q.Push(v, v % levels); }, [](auto& q, uint64_t& v) { return q.Pop(v); });
+    }
+
+    if (suite.selected("spsc")) {
+        benchSpsc(
+            suite, "RingBuf", capacity, [] { return std::make_unique<RingBuf<uint64_t, capacity>>(); },
+            [](auto& q, uint64_t& v) { return q.Write(&v, 1); }, [](auto& q, uint64_t& v) { return q.Read(&v, 1); });
+        benchSpsc(
+            suite, "Queue", capacity, [] { return std::make_unique<Queue<uint64_t, capacity>>(); },
+            [](auto& q, uint64_t& v) { return q.Push(v); }, [](auto& q, uint64_t& v) { return q.Pop(v); });
+        benchSpsc(
+            suite, "LockBasedBuffer", capacity, [] { return std::make_unique<LockBasedBuffer<uint64_t>>(capacity); },
+            [](auto& q, uint64_t& v) { return q.Write(v); }, [](auto& q, uint64_t& v) { return q.Read(v); });
+    }
+}
+
+const size_t BACKOFF_CAPACITY = 64;
+const int BACKOFF_KEY_RANGE = 256;
+
+// A small Queue and a short LinkedList, where retries are most frequent, with
+// one backoff policy. Run for each policy over the thread sweep to see which
+// keeps its throughput as threads are added.
+template <typename Backoff>
+void benchBackoff(BenchSuite& suite, const std::string& policy) {
+    benchPushPop(
+        suite, "backoff", "Queue<" + policy + ">", BACKOFF_CAPACITY, BACKOFF_CAPACITY / 2,
+        [] { return std::make_unique<Queue<uint64_t, BACKOFF_CAPACITY, CompactLayout, NoStats, Backoff>>(); },
+        [](auto& q, uint64_t v) { return q.Push(v); }, [](auto& q, uint64_t& v) { return q.Pop(v); });
+    benchSet<LinkedList<int, void*, std::less<int>, EpochReclaimer, NewAllocator, NoStats, Backoff>>(
+        suite, "backoff", "LinkedList<" + policy + ">", BACKOFF_KEY_RANGE);
+}
+
+std::vector<size_t> parseList(const std::string& text) {
+    std::vector<size_t> values;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        const unsigned long value = std::strtoul(text.substr(start, end - start).c_str(), nullptr, 10);
+        if (value > 0) {
+            values.push_back(value);
+        }
+        start = end + 1;
+    }
+    return values;
+}
+
+void usage() {
+    std::cout << "Usage: lockfree_bench [options]\n"
+                 "  --threads=1,2,4    thread counts to sweep (default: powers of two up to 2x cores)\n"
+                 "  --reps=N           measured repetitions per point (default 5)\n"
+                 "  --warmup=N         untimed warmup trials per point (default 1)\n"
+                 "  --duration-ms=N    length of one trial (default 200)\n"
+                 "  --filter=A,B       only the named structures\n"
+                 "                     (queue, priority, spsc, multiqueue, list, skiplist, hashmap,\n"
+                 "                     backoff)\n"
+                 "  --latency          measure enqueue-to-dequeue latency under offered load\n"
+                 "                     instead of throughput\n"
+                 "  --rate=N           latency mode: messages per second, all producers (default 100000)\n"
+                 "  --producers=N      latency mode: producer threads (default 1)\n"
+                 "  --consumers=N      latency mode: consumer threads (default 1)\n"
+                 "  --csv=PATH         write results as CSV\n"
+                 "  --json=PATH        write results as JSON\n";
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        const std::string key = arg.substr(0, eq);
+        const std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--threads") {
+            config.threads = parseList(value);
+        } else if (key == "--reps") {
+            config.repetitions = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (key == "--warmup") {
+            config.warmup = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (key == "--duration-ms") {
+            config.duration = std::chrono::milliseconds(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (key == "--latency") {
+            config.latency = true;
+        } else if (key == "--rate") {
+            config.rate = std::strtod(value.c_str(), nullptr);
+        } else if (key == "--producers") {
+            config.producers = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (key == "--consumers") {
+            config.consumers = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (key == "--filter") {
+            config.filter = value;
+        } else if (key == "--csv") {
+            config.csvPath = value;
+        } else if (key == "--json") {
+            config.jsonPath = value;
+        } else {
+            usage();
+            return key == "--help" ? 0 : 1;
+        }
+    }
+    if (config.repetitions == 0) {
+        config.repetitions = 1;
+    }
+    if (config.rate <= 0 || config.producers == 0 || config.consumers == 0) {
+        usage();
+        return 1;
+    }
+    if (config.threads.empty()) {
+        const size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+        for (size_t threads = 1; threads < 2 * cores; threads *= 2) {
+            config.threads.push_back(threads);
+        }
+        config.threads.push_back(2 * cores);
+    }
+
+    BenchSuite suite(config);
+
+    if (config.latency) {
+        runLatency(suite);
+        if (!suite.write()) {
+            std::cerr << "Could not write the result files." << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    benchBoundedQueues<64>(suite);
+    benchBoundedQueues<1024>(suite);
+    benchBoundedQueues<16384>(suite);
+
+    if (suite.selected("multiqueue")) {
+        benchPushPop(
+            suite, "multiqueue", "MultiQueue c=2", 0, 1024,
+            [] { return std::make_unique<MultiQueue<uint64_t, uint64_t>>(); },
+            [](auto& q, uint64_t v) { q.Push(v * 0x9E3779B97F4A7C15ULL, v); return true; },
+            [](auto& q, uint64_t& v) { uint64_t key; return q.TryPop(key, v); });
+        benchPushPop(
+            suite, "multiqueue", "Mutex std::priority_queue", 0, 1024,
+            [] { return std::make_unique<MutexPriorityQueue>(); },
+            [](auto& q, uint64_t v) { return q.Push(v, v * 0x9E3779B97F4A7C15ULL); },
+            [](auto& q, uint64_t& v) { return q.Pop(v); });
+    }
+
+    if (suite.selected("backoff")) {
+        benchBackoff<NoBackoff>(suite, "None");
+        benchBackoff<ConstantBackoff<>>(suite, "Constant");
+        benchBackoff<ConstantBackoff<1, true>>(suite, "Yield");
+        benchBackoff<ExponentialBackoff<>>(suite, "Exponential");
+        benchBackoff<ProportionalBackoff<>>(suite, "Proportional");
+    }
+
+    for (int keyRange : {256, 4096}) {
+        if (suite.selected("list")) {
+            benchSet<LockBasedLinkedList<>>(suite, "list", "LockBasedLinkedList", keyRange);
+            benchSet<LinkedList<int, void*, std::less<int>, HazardPointers>>(suite, "list",
+                                                                             "LinkedList<HazardPointers>", keyRange);
+            benchSet<LinkedList<int, void*, std::less<int>, EpochReclaimer>>(suite, "list",
+                                                                             "LinkedList<EpochReclaimer>", keyRange);
+        }
+    }
+
+    for (int keyRange : {1024, 65536}) {
+        if (suite.selected("skiplist")) {
+            benchSet<SkipList<>>(suite, "skiplist", "SkipList", keyRange);
+            benchSet<MutexSet<std::set<int>>>(suite, "skiplist", "Mutex std::set", keyRange);
+        }
+        if (suite.selected("hashmap")) {
+            benchSet<HashMap<HazardPointers>>(suite, "hashmap", "HashMap<HazardPointers>", keyRange);
+            benchSet<HashMap<EpochReclaimer>>(suite, "hashmap", "HashMap<EpochReclaimer>", keyRange);
+            benchSet<MutexHashMap>(suite, "hashmap", "Mutex unordered_map", keyRange);
+        }
+    }
+
+    if (!suite.write()) {
+        std::cerr << "Could not write the result files." << std::endl;
+        return 1;
+    }
+    return 0;
+}
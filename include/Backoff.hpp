@@ -0,0 +1,90 @@
+#ifndef BACKOFF_HPP
+#define BACKOFF_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "Platform.hpp"
+
+// Backoff policies for the retry loops in Queue, PriorityQueue, LinkedList
+// and SkipList.
+//
+// An operation constructs one policy object on entry and calls Pause() after
+// each lost CAS. Queue also calls Wait(distance) when its slot is still held
+// by an earlier revolution; distance is the number of slot operations that
+// must complete before this one can go, at least 1. Each policy is an empty
+// or one-word local, so the default NoBackoff compiles to exactly the loops
+// without it.
+//
+// Knobs are template parameters, so every policy is a distinct type and the
+// spin counts are compile-time constants.
+
+// Retries immediately. The default.
+struct NoBackoff {
+    void Pause() {}
+    void Wait(size_t) {}
+};
+
+// Spins a fixed number of CpuRelax() pauses, or yields the CPU instead when
+// Yield is set, after every failure.
+template <unsigned Spins = 8U, bool Yield = false> struct ConstantBackoff {
+    static_assert(Spins > 0U, "Spins must be positive");
+
+    void Pause() {
+        if constexpr (Yield) {
+            std::this_thread::yield();
+        } else {
+            for (unsigned i = 0; i < Spins; ++i) {
+                CpuRelax();
+            }
+        }
+    }
+    void Wait(size_t) { Pause(); }
+};
+
+// Randomised truncated exponential backoff: the n-th consecutive failure of
+// an operation spins a uniformly random count in [1, MinSpins * 2^n], capped
+// at MaxSpins. The randomness keeps threads that failed together from
+// retrying together.
+template <unsigned MinSpins = 4U, unsigned MaxSpins = 1024U> class ExponentialBackoff {
+    static_assert(MinSpins > 0U && MinSpins <= MaxSpins, "Need 0 < MinSpins <= MaxSpins");
+
+  public:
+    void Pause() {
+        const unsigned spins = 1U + static_cast<unsigned>(Random() % _limit);
+        for (unsigned i = 0; i < spins; ++i) {
+            CpuRelax();
+        }
+        _limit = _limit > MaxSpins / 2U ? MaxSpins : _limit * 2U;
+    }
+    void Wait(size_t) { Pause(); }
+
+  private:
+    static uint64_t Random() {
+        static thread_local uint64_t state = 0x9E3779B97F4A7C15ULL ^ reinterpret_cast<uintptr_t>(&state);
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    unsigned _limit = MinSpins;
+};
+
+// Waits in proportion to how far back in line the operation is, as in
+// Mellor-Crummey & Scott's ticket lock: SpinsPerTicket pauses per operation
+// ahead of it, capped at MaxSpins. A lost CAS counts as one ticket.
+template <unsigned SpinsPerTicket = 16U, unsigned MaxSpins = 4096U> struct ProportionalBackoff {
+    static_assert(SpinsPerTicket > 0U && SpinsPerTicket <= MaxSpins, "Need 0 < SpinsPerTicket <= MaxSpins");
+
+    void Pause() { Wait(1U); }
+    void Wait(size_t distance) {
+        const size_t spins = distance < MaxSpins / SpinsPerTicket ? distance * SpinsPerTicket : MaxSpins;
+        for (size_t i = 0; i < spins; ++i) {
+            CpuRelax();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef BLOCKING_QUEUE_HPP
+#define BLOCKING_QUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+#include "EventCount.hpp"
+#include "Platform.hpp"
+#include "Priority_Queue.hpp"
+#include "Queue.hpp"
+
+// Blocking front end for Queue and PriorityQueue.
+//
+// PushWait/PopWait first spin on the lock-free Push/Pop for a while, then park
+// on an EventCount until the other side makes progress. The spin budget adapts:
+// it grows when spinning pays off and shrinks when we end up parking anyway.
+// Extra arguments to PushWait (e.g. the priority) are forwarded to Push.
+//
+// Close() stops further pushes and wakes every waiter. PopWait keeps returning
+// elements until the queue is drained and then returns false, so consumers
+// need no external item counter to know when to stop. Pushes that race with
+// Close() may still land; call Close() once producers are finished.
+template <typename T, typename QueueType> class BlockingAdapter {
+  public:
+    using Clock = EventCount::Clock;
+
+    BlockingAdapter() : _closed(false), _spin_limit(MIN_SPIN) {}
+
+    template <typename... Args> bool TryPush(const T &element, Args... args);
+    bool TryPop(T &element);
+
+    template <typename... Args> bool PushWait(const T &element, Args... args);
+    bool PopWait(T &element);
+
+    template <typename Rep, typename Period, typename... Args>
+    bool PushWaitFor(const T &element,
+                     std::chrono::duration<Rep, Period> timeout, Args... args);
+    template <typename Rep, typename Period>
+    bool PopWaitFor(T &element, std::chrono::duration<Rep, Period> timeout);
+
+    void Close();
+    bool IsClosed() const;
+
+  private:
+    static constexpr size_t MIN_SPIN = 16U;
+    static constexpr size_t MAX_SPIN = 4096U;
+
+    template <typename TryOp>
+    bool Await(EventCount &event, TryOp try_op, const Clock::time_point *deadline);
+
+  private:
+    QueueType _queue;
+
+    std::atomic_bool _closed;
+    std::atomic_size_t _spin_limit;
+
+    EventCount _not_empty;
+    EventCount _not_full;
+};
+
+template <typename T, size_t size, typename Layout = CompactLayout>
+using BlockingQueue = BlockingAdapter<T, Queue<T, size, Layout>>;
+
+template <typename T, size_t size, size_t priority_count, typename Schedule = StrictPriority>
+using BlockingPriorityQueue =
+    BlockingAdapter<T, PriorityQueue<T, size, priority_count, Schedule>>;
+
+template <typename T, typename QueueType>
+template <typename... Args>
+bool BlockingAdapter<T, QueueType>::TryPush(const T &element, Args... args) {
+    if (_closed.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    if (!_queue.Push(element, args...)) {
+        return false;
+    }
+    _not_empty.NotifyOne();
+    return true;
+}
+
+template <typename T, typename QueueType>
+bool BlockingAdapter<T, QueueType>::TryPop(T &element) {
+    if (!_queue.Pop(element)) {
+        return false;
+    }
+    _not_full.NotifyOne();
+    return true;
+}
+
+template <typename T, typename QueueType>
+template <typename... Args>
+bool BlockingAdapter<T, QueueType>::PushWait(const T &element, Args... args) {
+    return Await(_not_full, [&] { return TryPush(element, args...); }, nullptr);
+}
+
+template <typename T, typename QueueType>
+bool BlockingAdapter<T, QueueType>::PopWait(T &element) {
+    return Await(_not_empty, [&] { return TryPop(element); }, nullptr);
+}
+
+template <typename T, typename QueueType>
+template <typename Rep, typename Period, typename... Args>
+bool BlockingAdapter<T, QueueType>::PushWaitFor(
+    const T &element, const std::chrono::duration<Rep, Period> timeout,
+    Args... args) {
+    const Clock::time_point deadline = Clock::now() + timeout;
+    return Await(_not_full, [&] { return TryPush(element, args...); },
+                 &deadline);
+}
+
+template <typename T, typename QueueType>
+template <typename Rep, typename Period>
+bool BlockingAdapter<T, QueueType>::PopWaitFor(
+    T &element, const std::chrono::duration<Rep, Period> timeout) {
+    const Clock::time_point deadline = Clock::now() + timeout;
+    return Await(_not_empty, [&] { return TryPop(element); }, &deadline);
+}
+
+template <typename T, typename QueueType>
+void BlockingAdapter<T, QueueType>::Close() {
+    _closed.store(true, std::memory_order_seq_cst);
+    _not_empty.NotifyAll();
+    _not_full.NotifyAll();
+}
+
+template <typename T, typename QueueType>
+bool BlockingAdapter<T, QueueType>::IsClosed() const {
+    return _closed.load(std::memory_order_acquire);
+}
+
+// Shared wait loop for both directions. Returns true once try_op succeeds and
+// false on timeout or when the adapter is closed (for pops: closed and empty).
+template <typename T, typename QueueType>
+template <typename TryOp>
+bool BlockingAdapter<T, QueueType>::Await(EventCount &event, TryOp try_op,
+                                          const Clock::time_point *deadline) {
+    const size_t spin_limit = _spin_limit.load(std::memory_order_relaxed);
+
+    for (size_t spin = 0U; spin < spin_limit; ++spin) {
+        if (try_op()) {
+            if (spin_limit < MAX_SPIN) {
+                _spin_limit.store(spin_limit * 2U, std::memory_order_relaxed);
+            }
+            return true;
+        }
+        if (_closed.load(std::memory_order_acquire)) {
+            return try_op();
+        }
+        CpuRelax();
+    }
+
+    if (spin_limit > MIN_SPIN) {
+        _spin_limit.store(spin_limit / 2U, std::memory_order_relaxed);
+    }
+
+    while (true) {
+        const EventCount::Key key = event.PrepareWait();
+
+        if (try_op()) {
+            event.CancelWait();
+            return true;
+        }
+        if (_closed.load(std::memory_order_acquire)) {
+            event.CancelWait();
+            return try_op();
+        }
+
+        if (deadline == nullptr) {
+            event.Wait(key);
+        } else if (!event.WaitUntil(key, *deadline)) {
+            return try_op();
+        }
+    }
+}
+
+#endif
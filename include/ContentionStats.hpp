@@ -0,0 +1,110 @@
+#ifndef CONTENTION_STATS_HPP
+#define CONTENTION_STATS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Layout.hpp"
+
+// Statistics policies for the CAS loops in Queue and LinkedList.
+//
+// A structure owns one StatsPolicy member and calls Add(counter) at each
+// event of interest. NoStats, the default, has an empty Add and no state, so
+// the calls and the member compile away. ContentionStats keeps one set of
+// counters per shard, each shard on its own cache line; a thread always
+// adds to the same shard, so counting costs an uncontended relaxed
+// fetch_add. Snapshot sums the shards on demand. It is not atomic across
+// counters: taken while operations run, it may be a few events out of step.
+
+enum class Stat : size_t {
+    OPERATIONS,       // Calls to an instrumented operation
+    CAS_FAILURES,     // Lost compare-exchanges on a shared index or link
+    TURN_WAITS,       // Reloads because a slot belonged to an earlier revolution
+    FULL_REJECTIONS,  // Pushes that found the queue full
+    EMPTY_REJECTIONS, // Pops that found the queue empty
+    RETRIES,          // Extra passes through an operation's loop
+    COUNT
+};
+
+struct StatsSnapshot {
+    uint64_t operations = 0U;
+    uint64_t cas_failures = 0U;
+    uint64_t turn_waits = 0U;
+    uint64_t full_rejections = 0U;
+    uint64_t empty_rejections = 0U;
+    uint64_t retries = 0U;
+
+    double RetriesPerOperation() const {
+        return operations == 0U ? 0.0 : static_cast<double>(retries) / static_cast<double>(operations);
+    }
+};
+
+struct NoStats {
+    static constexpr bool enabled = false;
+
+    void Add(Stat, uint64_t = 1U) {}
+    StatsSnapshot Snapshot() const { return {}; }
+    void Reset() {}
+};
+
+class ContentionStats {
+  public:
+    static constexpr bool enabled = true;
+
+    void Add(Stat counter, uint64_t amount = 1U) {
+        _shards[ShardIndex()].counts[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    StatsSnapshot Snapshot() const;
+
+    // Must not race with Add.
+    void Reset();
+
+  private:
+    static constexpr size_t SHARDS = 64U;
+    static constexpr size_t COUNTERS = static_cast<size_t>(Stat::COUNT);
+
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        std::atomic<uint64_t> counts[COUNTERS] = {};
+    };
+
+    // Threads are dealt shards round robin on first use, so up to SHARDS
+    // threads never share one.
+    static size_t ShardIndex() {
+        static std::atomic_size_t next_shard{0U};
+        static thread_local size_t shard = next_shard.fetch_add(1U, std::memory_order_relaxed) % SHARDS;
+        return shard;
+    }
+
+    uint64_t Sum(Stat counter) const {
+        uint64_t total = 0U;
+        for (const auto &shard : _shards) {
+            total += shard.counts[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    Shard _shards[SHARDS];
+};
+
+inline StatsSnapshot ContentionStats::Snapshot() const {
+    StatsSnapshot snapshot;
+    snapshot.operations = Sum(Stat::OPERATIONS);
+    snapshot.cas_failures = Sum(Stat::CAS_FAILURES);
+    snapshot.turn_waits = Sum(Stat::TURN_WAITS);
+    snapshot.full_rejections = Sum(Stat::FULL_REJECTIONS);
+    snapshot.empty_rejections = Sum(Stat::EMPTY_REJECTIONS);
+    snapshot.retries = Sum(Stat::RETRIES);
+    return snapshot;
+}
+
+inline void ContentionStats::Reset() {
+    for (auto &shard : _shards) {
+        for (auto &count : shard.counts) {
+            count.store(0U, std::memory_order_relaxed);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,314 @@
+#ifndef EPOCH_RECLAIMER_HPP
+#define EPOCH_RECLAIMER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Layout.hpp"
+
+// Epoch-based safe memory reclamation (Fraser, 2004).
+//
+// Threads announce the global epoch when they enter a critical section
+// (a Guard) and clear the announcement when they leave. A node unlinked while
+// the global epoch is e goes into the retiring thread's limbo list for e and
+// may be freed once the epoch has reached e + 2: by then every thread that
+// could still hold a reference has left its critical section. The epoch only
+// advances when every thread inside a critical section has announced the
+// current one.
+//
+// Unlike hazard pointers, readers pay one store and one fence per operation
+// instead of one per node visited, at the price of unbounded garbage if a
+// thread stalls inside a Guard. Guards nest on the same thread.
+//
+// Garbage still too young to free when a thread exits is handed to a global
+// orphan list, tagged with its epoch, and freed by whichever thread collects
+// next once that epoch is old enough.
+//
+// Policy interface shared with HazardPointers: a nested Guard type with
+// protect/clear (no-ops here) and retire, plus PROTECTS_POINTERS telling
+// containers whether they need to publish and re-validate every hop.
+class EpochReclaimer {
+  public:
+    static constexpr bool PROTECTS_POINTERS = false;
+
+    class Guard;
+
+    // Number of retired nodes not yet freed, across all threads.
+    static size_t RetiredCount();
+
+  private:
+    static constexpr size_t LIMBO_LISTS = 3U;
+    static constexpr size_t ADVANCE_THRESHOLD = 64U;
+
+    struct Retired {
+        void *ptr;
+        void (*deleter)(void *);
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Record {
+        // (announced epoch << 1) | 1 while inside a critical section.
+        std::atomic<uint64_t> state;
+        std::atomic_bool in_use;
+        Record *next;
+
+        size_t depth;
+        size_t retired_since_advance;
+        uint64_t limbo_epoch[LIMBO_LISTS];
+        std::vector<Retired> limbo[LIMBO_LISTS];
+
+        Record()
+            : state(0U), in_use(true), next(nullptr), depth(0U),
+              retired_since_advance(0U), limbo_epoch{0U, 0U, 0U} {}
+    };
+
+    struct ThreadCache {
+        Record *record = nullptr;
+
+        ~ThreadCache();
+    };
+
+    // A limbo list left behind by an exiting thread.
+    struct Orphan {
+        uint64_t epoch;
+        std::vector<Retired> nodes;
+        Orphan *next;
+    };
+
+    static Record *AcquireRecord();
+    static Record *ThreadRecord();
+    static void Enter(Record *record);
+    static void Exit(Record *record);
+    static void Retire(Record *record, void *ptr, void (*deleter)(void *));
+    static bool TryAdvance();
+    static void Collect(Record *record);
+    static void Abandon(Record *record);
+    static void CollectOrphans();
+    static void PushOrphans(Orphan *first, Orphan *last);
+    static void FreeList(std::vector<Retired> &list);
+
+    static std::atomic<uint64_t> &GlobalEpoch();
+    static std::atomic<Record *> &Records();
+    static std::atomic<Orphan *> &Orphans();
+    static std::atomic_size_t &Outstanding();
+};
+
+// Scoped critical section. Pointers read from shared nodes stay valid until
+// the guard is destroyed.
+class EpochReclaimer::Guard {
+  public:
+    Guard() : _record(ThreadRecord()) { Enter(_record); }
+    ~Guard() { Exit(_record); }
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+
+    template <typename T> void protect(size_t, T *) {}
+    void clear(size_t) {}
+
+    template <typename T> void retire(T *ptr) {
+        retire(ptr, [](void *p) { delete static_cast<T *>(p); });
+    }
+    void retire(void *ptr, void (*deleter)(void *)) {
+        Retire(_record, ptr, deleter);
+    }
+
+  private:
+    Record *_record;
+};
+
+inline std::atomic<uint64_t> &EpochReclaimer::GlobalEpoch() {
+    static std::atomic<uint64_t> epoch{LIMBO_LISTS};
+    return epoch;
+}
+
+inline std::atomic<EpochReclaimer::Record *> &EpochReclaimer::Records() {
+    static std::atomic<Record *> records{nullptr};
+    return records;
+}
+
+inline std::atomic<EpochReclaimer::Orphan *> &EpochReclaimer::Orphans() {
+    static std::atomic<Orphan *> orphans{nullptr};
+    return orphans;
+}
+
+inline std::atomic_size_t &EpochReclaimer::Outstanding() {
+    static std::atomic_size_t outstanding{0U};
+    return outstanding;
+}
+
+inline size_t EpochReclaimer::RetiredCount() {
+    return Outstanding().load(std::memory_order_relaxed);
+}
+
+inline EpochReclaimer::ThreadCache::~ThreadCache() {
+    if (record != nullptr) {
+        // Give the garbage a chance to age out before handing the record on.
+        for (size_t i = 0U; i < LIMBO_LISTS; ++i) {
+            TryAdvance();
+        }
+        Collect(record);
+        Abandon(record);
+        record->in_use.store(false, std::memory_order_release);
+    }
+}
+
+inline EpochReclaimer::Record *EpochReclaimer::AcquireRecord() {
+    for (Record *record = Records().load(std::memory_order_acquire);
+         record != nullptr; record = record->next) {
+        bool expected = false;
+        if (!record->in_use.load(std::memory_order_relaxed) &&
+            record->in_use.compare_exchange_strong(expected, true,
+                                                   std::memory_order_acquire)) {
+            return record;
+        }
+    }
+
+    Record *record = new Record();
+    Record *head = Records().load(std::memory_order_relaxed);
+    do {
+        record->next = head;
+    } while (!Records().compare_exchange_weak(head, record,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+    return record;
+}
+
+inline EpochReclaimer::Record *EpochReclaimer::ThreadRecord() {
+    static thread_local ThreadCache cache;
+    if (cache.record == nullptr) {
+        cache.record = AcquireRecord();
+    }
+    return cache.record;
+}
+
+inline void EpochReclaimer::Enter(Record *record) {
+    if (record->depth++ != 0U) {
+        return;
+    }
+    const uint64_t epoch = GlobalEpoch().load(std::memory_order_relaxed);
+    // A seq_cst RMW orders the announcement before any load of shared nodes,
+    // and keeps the release sequence of the previous Exit() going so that
+    // TryAdvance synchronises with everything that critical section read.
+    record->state.exchange((epoch << 1U) | 1U, std::memory_order_seq_cst);
+}
+
+inline void EpochReclaimer::Exit(Record *record) {
+    if (--record->depth != 0U) {
+        return;
+    }
+    record->state.store(record->state.load(std::memory_order_relaxed) & ~1ULL,
+                        std::memory_order_release);
+}
+
+inline void EpochReclaimer::Retire(Record *record, void *ptr,
+                                   void (*deleter)(void *)) {
+    const uint64_t epoch = GlobalEpoch().load(std::memory_order_acquire);
+    const size_t bucket = epoch % LIMBO_LISTS;
+
+    // A bucket still tagged with an older epoch holds garbage from at least
+    // LIMBO_LISTS epochs ago, which is safe to free now.
+    if (record->limbo_epoch[bucket] != epoch) {
+        FreeList(record->limbo[bucket]);
+        record->limbo_epoch[bucket] = epoch;
+    }
+    record->limbo[bucket].push_back({ptr, deleter});
+    Outstanding().fetch_add(1U, std::memory_order_relaxed);
+
+    if (++record->retired_since_advance >= ADVANCE_THRESHOLD) {
+        record->retired_since_advance = 0U;
+        TryAdvance();
+        Collect(record);
+    }
+}
+
+inline bool EpochReclaimer::TryAdvance() {
+    uint64_t epoch = GlobalEpoch().load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    for (Record *record = Records().load(std::memory_order_acquire);
+         record != nullptr; record = record->next) {
+        const uint64_t state = record->state.load(std::memory_order_acquire);
+        if ((state & 1U) != 0U && (state >> 1U) != epoch) {
+            return false;
+        }
+    }
+
+    return GlobalEpoch().compare_exchange_strong(epoch, epoch + 1U,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed);
+}
+
+inline void EpochReclaimer::Collect(Record *record) {
+    const uint64_t epoch = GlobalEpoch().load(std::memory_order_acquire);
+    for (size_t bucket = 0U; bucket < LIMBO_LISTS; ++bucket) {
+        if (record->limbo_epoch[bucket] + 2U <= epoch) {
+            FreeList(record->limbo[bucket]);
+        }
+    }
+    CollectOrphans();
+}
+
+// Moves whatever garbage record still holds onto the orphan list, so it does
+// not wait for another thread to reuse the record.
+inline void EpochReclaimer::Abandon(Record *record) {
+    for (size_t bucket = 0U; bucket < LIMBO_LISTS; ++bucket) {
+        if (!record->limbo[bucket].empty()) {
+            Orphan *orphan = new Orphan{record->limbo_epoch[bucket], std::move(record->limbo[bucket]), nullptr};
+            record->limbo[bucket].clear();
+            PushOrphans(orphan, orphan);
+        }
+    }
+}
+
+// Frees the orphans old enough to go, as Collect does for a record's own
+// lists. Takes the whole list at once and pushes back the rest, so no two
+// threads ever look at the same orphan.
+inline void EpochReclaimer::CollectOrphans() {
+    if (Orphans().load(std::memory_order_relaxed) == nullptr) {
+        return;
+    }
+    Orphan *orphan = Orphans().exchange(nullptr, std::memory_order_acquire);
+    const uint64_t epoch = GlobalEpoch().load(std::memory_order_acquire);
+
+    Orphan *first = nullptr;
+    Orphan *last = nullptr;
+    while (orphan != nullptr) {
+        Orphan *next = orphan->next;
+        if (orphan->epoch + 2U <= epoch) {
+            FreeList(orphan->nodes);
+            delete orphan;
+        } else {
+            orphan->next = first;
+            first = orphan;
+            if (last == nullptr) {
+                last = orphan;
+            }
+        }
+        orphan = next;
+    }
+    if (first != nullptr) {
+        PushOrphans(first, last);
+    }
+}
+
+// Pushes the chain first..last onto the orphan list.
+inline void EpochReclaimer::PushOrphans(Orphan *first, Orphan *last) {
+    Orphan *head = Orphans().load(std::memory_order_relaxed);
+    do {
+        last->next = head;
+    } while (!Orphans().compare_exchange_weak(head, first,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+}
+
+inline void EpochReclaimer::FreeList(std::vector<Retired> &list) {
+    for (const Retired &node : list) {
+        node.deleter(node.ptr);
+    }
+    Outstanding().fetch_sub(list.size(), std::memory_order_relaxed);
+    list.clear();
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef EVENT_COUNT_HPP
+#define EVENT_COUNT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <climits>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// Lets threads sleep until a condition they poll lock-free becomes true.
+//
+// A waiter calls PrepareWait(), re-checks its condition, and then either
+// CancelWait()s or Wait()s on the returned key. A notifier makes the condition
+// true and then calls NotifyOne()/NotifyAll(). The notify path is a fence and
+// one load when nobody is waiting, so it can sit on every Push/Pop.
+//
+// On Linux the epoch word is parked on with a private futex, which also gives
+// us timed waits. Elsewhere std::atomic::wait is used for untimed waits and
+// timed waits fall back to a short sleep loop.
+class EventCount {
+  public:
+    using Key = uint32_t;
+    using Clock = std::chrono::steady_clock;
+
+    EventCount() : _epoch(0U), _waiters(0U) {}
+    EventCount(const EventCount &) = delete;
+    EventCount &operator=(const EventCount &) = delete;
+
+    Key PrepareWait();
+    void CancelWait();
+    void Wait(Key key);
+    bool WaitUntil(Key key, Clock::time_point deadline);
+
+    void NotifyOne();
+    void NotifyAll();
+
+  private:
+    void Notify(int count);
+
+    std::atomic<uint32_t> _epoch;
+    std::atomic<uint32_t> _waiters;
+};
+
+inline EventCount::Key EventCount::PrepareWait() {
+    _waiters.fetch_add(1U, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return _epoch.load(std::memory_order_acquire);
+}
+
+inline void EventCount::CancelWait() {
+    _waiters.fetch_sub(1U, std::memory_order_relaxed);
+}
+
+inline void EventCount::Wait(const Key key) {
+    while (_epoch.load(std::memory_order_acquire) == key) {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&_epoch),
+                FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+#else
+        _epoch.wait(key, std::memory_order_acquire);
+#endif
+    }
+    _waiters.fetch_sub(1U, std::memory_order_relaxed);
+}
+
+// Returns false if the deadline passed before a notification arrived.
+inline bool EventCount::WaitUntil(const Key key,
+                                  const Clock::time_point deadline) {
+    while (_epoch.load(std::memory_order_acquire) == key) {
+        const auto now = Clock::now();
+        if (now >= deadline) {
+            _waiters.fetch_sub(1U, std::memory_order_relaxed);
+            return false;
+        }
+#if defined(__linux__)
+        const auto remaining =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now);
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(remaining.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(remaining.count() % 1000000000);
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&_epoch),
+                FUTEX_WAIT_PRIVATE, key, &ts, nullptr, 0);
+#else
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+#endif
+    }
+    _waiters.fetch_sub(1U, std::memory_order_relaxed);
+    return true;
+}
+
+inline void EventCount::NotifyOne() { Notify(1); }
+
+inline void EventCount::NotifyAll() { Notify(INT_MAX); }
+
+inline void EventCount::Notify(const int count) {
+    // Pairs with the fence in PrepareWait: either the waiter sees the
+    // condition we just made true, or we see its registration here.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waiters.load(std::memory_order_relaxed) == 0U) {
+        return;
+    }
+
+    _epoch.fetch_add(1U, std::memory_order_release);
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&_epoch),
+            FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+    if (count == 1) {
+        _epoch.notify_one();
+    } else {
+        _epoch.notify_all();
+    }
+#endif
+}
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "The futex word must be a plain 32-bit integer");
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef HARRIS_LIST_HPP
+#define HARRIS_LIST_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include "Backoff.hpp"
+#include "ContentionStats.hpp"
+#include "MarkedPointer.hpp"
+
+// The Harris / Michael ordered-list algorithms shared by LinkedList and
+// HashMap: search with helping, insert, and two-step delete on marked
+// pointers. The owner keeps the nodes and the entry point; HarrisList only
+// walks and relinks them.
+//
+// Node must derive from ListLink<Node> and provide a static destroy(void*),
+// which the reclaimer calls on unlinked nodes. A list ends at nullptr or at a
+// tail sentinel that every search stops at. Positions are described by
+// predicates instead of a key type: before(node) is true for the nodes
+// ordered ahead of the target, and matches(node) for the node holding it;
+// matches may be passed nullptr, the end of the list. The start link must
+// stay linked for the whole call, as the head or a never-deleted sentinel.
+//
+// StatsPolicy counts the lost CASes and restarts of these loops, and Backoff
+// paces them; see ContentionStats.hpp and Backoff.hpp.
+template <typename Node>
+struct ListLink {
+    std::atomic<Node*> next{nullptr};
+};
+
+template <typename Node, typename Reclaimer, typename StatsPolicy = NoStats, typename Backoff = NoBackoff>
+class HarrisList {
+public:
+    using Link = ListLink<Node>;
+    using Guard = typename Reclaimer::Guard;
+
+    // Hazard slots used by search.
+    static constexpr size_t HP_PREV = 0;
+    static constexpr size_t HP_CURR = 1;
+
+    // Finds the first node after start that is not before the target
+    // (nullptr at the end of the list) and the link before it, unlinking
+    // marked nodes on the way. Both were adjacent and unmarked at some point
+    // during the call, and stay protected by guard on return.
+    template <typename Before>
+    std::pair<Link*, Node*> search(Link* start, Before before, Guard& guard);
+
+    // Links the node returned by make() at the target position unless a
+    // matching node is already there. Returns the node now holding the
+    // target, protected by guard, and whether it is the new one. make is
+    // called at most once.
+    template <typename Before, typename Matches, typename Make>
+    std::pair<Node*, bool> insert(Link* start, Before before, Matches matches, Make make, Guard& guard);
+
+    // Deletes the matching node: marks it, which is the linearisation point,
+    // then unlinks and retires it. Returns false if there was none.
+    template <typename Before, typename Matches>
+    bool remove(Link* start, Before before, Matches matches, Guard& guard);
+
+    [[no_unique_address]] StatsPolicy contention;
+};
+
+template <typename Node, typename Reclaimer, typename StatsPolicy, typename Backoff>
+template <typename Before>
+std::pair<typename HarrisList<Node, Reclaimer, StatsPolicy, Backoff>::Link*, Node*>
+HarrisList<Node, Reclaimer, StatsPolicy, Backoff>::search(Link* start, Before before, Guard& guard) {
+    Backoff backoff;
+retry:
+    Link* prev = start;
+    Node* curr = prev->next.load(std::memory_order_acquire);
+
+    while (curr != nullptr) {
+        if constexpr (Reclaimer::PROTECTS_POINTERS) {
+            // Publish curr, then make sure prev still points at it;
+            // otherwise it may already have been retired.
+            guard.protect(HP_CURR, curr);
+            if (prev->next.load(std::memory_order_acquire) != curr) {
+                contention.Add(Stat::RETRIES);
+                goto retry;
+            }
+        }
+
+        Node* next = curr->next.load(std::memory_order_acquire);
+
+        if (IsMarked(next)) {
+            // curr is logically deleted: help unlink it. Failure means prev
+            // changed or was itself deleted, so start over.
+            Node* expected = curr;
+            if (!prev->next.compare_exchange_strong(expected, Unmarked(next),
+                                                    std::memory_order_acq_rel,
+                                                    std::memory_order_acquire)) {
+                contention.Add(Stat::CAS_FAILURES);
+                contention.Add(Stat::RETRIES);
+                backoff.Pause();
+                goto retry;
+            }
+            guard.retire(curr, &Node::destroy);
+            curr = Unmarked(next);
+            continue;
+        }
+
+        if (!before(curr)) {
+            break;
+        }
+        guard.protect(HP_PREV, curr);
+        prev = curr;
+        curr = next;
+    }
+    return {prev, curr};
+}
+
+template <typename Node, typename Reclaimer, typename StatsPolicy, typename Backoff>
+template <typename Before, typename Matches, typename Make>
+std::pair<Node*, bool> HarrisList<Node, Reclaimer, StatsPolicy, Backoff>::insert(Link* start, Before before,
+                                                                                 Matches matches, Make make,
+                                                                                 Guard& guard) {
+    Node* newNode = nullptr;
+    Backoff backoff;
+
+    while (true) {
+        auto [prev, next] = search(start, before, guard);
+
+        if (matches(next)) {
+            if (newNode != nullptr) {
+                Node::destroy(newNode);
+            }
+            return {next, false};
+        }
+
+        if (newNode == nullptr) {
+            newNode = make();
+        }
+        newNode->next.store(next, std::memory_order_relaxed);
+
+        if (prev->next.compare_exchange_strong(next, newNode,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+            return {newNode, true};
+        }
+        contention.Add(Stat::CAS_FAILURES);
+        contention.Add(Stat::RETRIES);
+        backoff.Pause();
+    }
+}
+
+template <typename Node, typename Reclaimer, typename StatsPolicy, typename Backoff>
+template <typename Before, typename Matches>
+bool HarrisList<Node, Reclaimer, StatsPolicy, Backoff>::remove(Link* start, Before before, Matches matches,
+                                                               Guard& guard) {
+    Backoff backoff;
+
+    while (true) {
+        auto [prev, delNode] = search(start, before, guard);
+
+        if (!matches(delNode)) return false; // Node not found
+
+        Node* next = delNode->next.load(std::memory_order_acquire);
+        if (IsMarked(next)) {
+            contention.Add(Stat::RETRIES);
+            continue; // Another thread is deleting it; let search finish the unlink
+        }
+
+        // Logical delete. Once marked, delNode->next can no longer change.
+        if (!delNode->next.compare_exchange_strong(next, Marked(next),
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_relaxed)) {
+            contention.Add(Stat::CAS_FAILURES);
+            contention.Add(Stat::RETRIES);
+            backoff.Pause();
+            continue;
+        }
+
+        // Physical delete; if it fails, a traversal will unlink it for us.
+        Node* expected = delNode;
+        if (prev->next.compare_exchange_strong(expected, next,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_relaxed)) {
+            guard.retire(delNode, &Node::destroy);
+        } else {
+            contention.Add(Stat::CAS_FAILURES);
+            search(start, before, guard);
+        }
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,240 @@
+#ifndef HAZARD_POINTERS_HPP
+#define HAZARD_POINTERS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "Layout.hpp"
+
+// Hazard-pointer based safe memory reclamation (Michael, 2004).
+//
+// Every thread owns a record with HAZARD_SLOTS published pointers. Before
+// dereferencing a shared node, a reader publishes it in one of its slots and
+// then re-validates that the node is still reachable. A node that has been
+// unlinked is retired onto the retiring thread's private list, and once that
+// list grows past a threshold proportional to the total number of slots, a
+// scan frees every retired node that no slot currently publishes. This keeps
+// the number of unreclaimed nodes bounded by O(threads * slots) per thread.
+//
+// Records are never freed; a thread releases its record on exit and the next
+// new thread adopts it, together with any retired nodes still on it.
+class HazardPointers {
+  public:
+    static constexpr bool PROTECTS_POINTERS = true;
+    static constexpr size_t HAZARD_SLOTS = 4U;
+
+    class Guard;
+
+    // Number of retired nodes not yet freed, across all threads.
+    static size_t RetiredCount();
+
+  private:
+    struct Retired {
+        void *ptr;
+        void (*deleter)(void *);
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Record {
+        std::atomic<const void *> hazards[HAZARD_SLOTS];
+        std::atomic_bool in_use;
+        Record *next;
+        std::vector<Retired> retired;
+
+        Record() : in_use(true), next(nullptr) {
+            for (auto &hazard : hazards) {
+                hazard.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    // Caches the calling thread's record between operations.
+    struct ThreadCache {
+        Record *record = nullptr;
+        bool busy = false;
+
+        ~ThreadCache();
+    };
+
+    static Record *AcquireRecord();
+    static void ReleaseRecord(Record *record);
+    static void Retire(Record *record, void *ptr, void (*deleter)(void *));
+    static void Scan(Record *record);
+
+    static std::atomic<Record *> &Records();
+    static std::atomic_size_t &RecordCount();
+    static std::atomic_size_t &Outstanding();
+    static ThreadCache &Cache();
+};
+
+// Scoped access to the calling thread's hazard slots for one operation.
+// Guards may nest; an inner guard borrows a separate record.
+class HazardPointers::Guard {
+  public:
+    Guard();
+    ~Guard();
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+
+    // Publishes ptr in the given slot. The caller must re-check that ptr is
+    // still reachable afterwards before dereferencing it.
+    template <typename T> void protect(size_t slot, T *ptr);
+    void clear(size_t slot);
+
+    template <typename T> void retire(T *ptr);
+    void retire(void *ptr, void (*deleter)(void *));
+
+  private:
+    Record *_record;
+    bool _cached;
+};
+
+inline std::atomic<HazardPointers::Record *> &HazardPointers::Records() {
+    static std::atomic<Record *> records{nullptr};
+    return records;
+}
+
+inline std::atomic_size_t &HazardPointers::RecordCount() {
+    static std::atomic_size_t count{0U};
+    return count;
+}
+
+inline std::atomic_size_t &HazardPointers::Outstanding() {
+    static std::atomic_size_t outstanding{0U};
+    return outstanding;
+}
+
+inline HazardPointers::ThreadCache &HazardPointers::Cache() {
+    static thread_local ThreadCache cache;
+    return cache;
+}
+
+inline size_t HazardPointers::RetiredCount() {
+    return Outstanding().load(std::memory_order_relaxed);
+}
+
+inline HazardPointers::ThreadCache::~ThreadCache() {
+    if (record != nullptr) {
+        Scan(record);
+        ReleaseRecord(record);
+    }
+}
+
+inline HazardPointers::Record *HazardPointers::AcquireRecord() {
+    for (Record *record = Records().load(std::memory_order_acquire);
+         record != nullptr; record = record->next) {
+        bool expected = false;
+        if (!record->in_use.load(std::memory_order_relaxed) &&
+            record->in_use.compare_exchange_strong(expected, true,
+                                                   std::memory_order_acquire)) {
+            return record;
+        }
+    }
+
+    Record *record = new Record();
+    Record *head = Records().load(std::memory_order_relaxed);
+    do {
+        record->next = head;
+    } while (!Records().compare_exchange_weak(head, record,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+    RecordCount().fetch_add(1U, std::memory_order_relaxed);
+    return record;
+}
+
+inline void HazardPointers::ReleaseRecord(Record *record) {
+    for (auto &hazard : record->hazards) {
+        hazard.store(nullptr, std::memory_order_release);
+    }
+    record->in_use.store(false, std::memory_order_release);
+}
+
+inline void HazardPointers::Retire(Record *record, void *ptr,
+                                   void (*deleter)(void *)) {
+    record->retired.push_back({ptr, deleter});
+    Outstanding().fetch_add(1U, std::memory_order_relaxed);
+
+    const size_t threshold = std::max<size_t>(
+        64U, 2U * HAZARD_SLOTS * RecordCount().load(std::memory_order_relaxed));
+    if (record->retired.size() >= threshold) {
+        Scan(record);
+    }
+}
+
+inline void HazardPointers::Scan(Record *record) {
+    // Pairs with the seq_cst store in Guard::protect: a reader either sees
+    // the node unlinked during validation, or we see its hazard here.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::vector<const void *> hazards;
+    hazards.reserve(HAZARD_SLOTS * RecordCount().load(std::memory_order_relaxed));
+    for (Record *other = Records().load(std::memory_order_acquire);
+         other != nullptr; other = other->next) {
+        for (const auto &hazard : other->hazards) {
+            const void *ptr = hazard.load(std::memory_order_acquire);
+            if (ptr != nullptr) {
+                hazards.push_back(ptr);
+            }
+        }
+    }
+    std::sort(hazards.begin(), hazards.end());
+
+    size_t kept = 0U;
+    for (const Retired &node : record->retired) {
+        if (std::binary_search(hazards.begin(), hazards.end(),
+                               static_cast<const void *>(node.ptr))) {
+            record->retired[kept++] = node;
+        } else {
+            node.deleter(node.ptr);
+        }
+    }
+    Outstanding().fetch_sub(record->retired.size() - kept,
+                            std::memory_order_relaxed);
+    record->retired.resize(kept);
+}
+
+inline HazardPointers::Guard::Guard() : _record(nullptr), _cached(false) {
+    ThreadCache &cache = Cache();
+    if (!cache.busy) {
+        if (cache.record == nullptr) {
+            cache.record = AcquireRecord();
+        }
+        cache.busy = true;
+        _record = cache.record;
+        _cached = true;
+    } else {
+        _record = AcquireRecord();
+    }
+}
+
+inline HazardPointers::Guard::~Guard() {
+    if (_cached) {
+        for (auto &hazard : _record->hazards) {
+            hazard.store(nullptr, std::memory_order_release);
+        }
+        Cache().busy = false;
+    } else {
+        ReleaseRecord(_record);
+    }
+}
+
+template <typename T>
+inline void HazardPointers::Guard::protect(const size_t slot, T *ptr) {
+    // seq_cst orders the publication before the caller's validating load.
+    _record->hazards[slot].store(ptr, std::memory_order_seq_cst);
+}
+
+inline void HazardPointers::Guard::clear(const size_t slot) {
+    _record->hazards[slot].store(nullptr, std::memory_order_release);
+}
+
+template <typename T> inline void HazardPointers::Guard::retire(T *ptr) {
+    retire(ptr, [](void *p) { delete static_cast<T *>(p); });
+}
+
+inline void HazardPointers::Guard::retire(void *ptr, void (*deleter)(void *)) {
+    HazardPointers::Retire(_record, ptr, deleter);
+}
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear latency histogram in the style of HdrHistogram.
+//
+// Values (nanoseconds, say) below 2^SUB_BITS get a bucket each. Above that,
+// every power-of-two range is split into 2^SUB_BITS linear sub-buckets, so a
+// recorded value is reported with a relative error below 2^-SUB_BITS (about
+// 3%) anywhere in the 64-bit range. Recording is a count-leading-zeros, a
+// shift and a relaxed load/store of one counter: no allocation, no locks and
+// no read-modify-write.
+//
+// Each histogram has a single writer. Other threads may read it (Count,
+// Percentile, Merge from it) at any time and see a slightly stale but
+// untorn snapshot. To aggregate, give every thread its own histogram and
+// Merge them into one owned by the reader.
+class LatencyHistogram {
+  public:
+    static constexpr unsigned SUB_BITS = 5U;
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    // Writer only.
+    void Record(uint64_t value);
+    void Reset();
+
+    // Adds other's counts into this histogram. This one must not have a
+    // concurrent writer.
+    void Merge(const LatencyHistogram &other);
+
+    uint64_t Count() const { return _count.load(std::memory_order_relaxed); }
+    uint64_t Max() const { return _max.load(std::memory_order_relaxed); }
+    double Mean() const;
+    // Smallest recorded bucket bound with at least fraction of the values at
+    // or below it; fraction is in [0, 1]. Returns 0 for an empty histogram.
+    uint64_t Percentile(double fraction) const;
+
+  private:
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BITS;
+    static constexpr size_t BUCKETS = (64U - SUB_BITS + 1U) * SUB_BUCKETS;
+
+    static size_t BucketOf(uint64_t value);
+    // Largest value that maps to bucket.
+    static uint64_t UpperBound(size_t bucket);
+
+    static void Add(std::atomic<uint64_t> &counter, uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> _count{0U};
+    std::atomic<uint64_t> _sum{0U};
+    std::atomic<uint64_t> _max{0U};
+    std::atomic<uint64_t> _buckets[BUCKETS] = {};
+};
+
+inline size_t LatencyHistogram::BucketOf(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    const unsigned shift = 63U - static_cast<unsigned>(std::countl_zero(value)) - SUB_BITS;
+    return (shift + 1U) * SUB_BUCKETS + static_cast<size_t>((value >> shift) - SUB_BUCKETS);
+}
+
+inline uint64_t LatencyHistogram::UpperBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    const unsigned shift = static_cast<unsigned>(bucket / SUB_BUCKETS) - 1U;
+    const uint64_t mantissa = SUB_BUCKETS + bucket % SUB_BUCKETS;
+    // The very last bucket ends at UINT64_MAX; this wraps to it.
+    return ((mantissa + 1U) << shift) - 1U;
+}
+
+inline void LatencyHistogram::Record(uint64_t value) {
+    Add(_buckets[BucketOf(value)], 1U);
+    Add(_count, 1U);
+    Add(_sum, value);
+    if (value > _max.load(std::memory_order_relaxed)) {
+        _max.store(value, std::memory_order_relaxed);
+    }
+}
+
+inline void LatencyHistogram::Reset() {
+    for (auto &bucket : _buckets) {
+        bucket.store(0U, std::memory_order_relaxed);
+    }
+    _count.store(0U, std::memory_order_relaxed);
+    _sum.store(0U, std::memory_order_relaxed);
+    _max.store(0U, std::memory_order_relaxed);
+}
+
+inline void LatencyHistogram::Merge(const LatencyHistogram &other) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        const uint64_t count = other._buckets[i].load(std::memory_order_relaxed);
+        if (count != 0U) {
+            Add(_buckets[i], count);
+        }
+    }
+    Add(_count, other._count.load(std::memory_order_relaxed));
+    Add(_sum, other._sum.load(std::memory_order_relaxed));
+    const uint64_t max = other._max.load(std::memory_order_relaxed);
+    if (max > _max.load(std::memory_order_relaxed)) {
+        _max.store(max, std::memory_order_relaxed);
+    }
+}
+
+inline double LatencyHistogram::Mean() const {
+    const uint64_t count = Count();
+    return count == 0U ? 0.0
+                       : static_cast<double>(_sum.load(std::memory_order_relaxed)) / static_cast<double>(count);
+}
+
+inline uint64_t LatencyHistogram::Percentile(double fraction) const {
+    // Sum the buckets rather than trusting _count, which a concurrent writer
+    // may have bumped ahead of or behind them.
+    uint64_t total = 0U;
+    for (const auto &bucket : _buckets) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0U) {
+        return 0U;
+    }
+
+    fraction = fraction < 0.0 ? 0.0 : (fraction > 1.0 ? 1.0 : fraction);
+    uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(total) + 0.5);
+    rank = rank == 0U ? 1U : rank;
+
+    uint64_t seen = 0U;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // Never report beyond the largest value actually recorded.
+            const uint64_t bound = UpperBound(i);
+            const uint64_t max = Max();
+            return bound < max ? bound : max;
+        }
+    }
+    return Max();
+}
+
+#endif
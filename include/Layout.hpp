@@ -0,0 +1,28 @@
+#ifndef LAYOUT_HPP
+#define LAYOUT_HPP
+
+#include <atomic>
+#include <cstddef>
+
+// Assumed size of a cache line on the target. Kept as a plain constant rather
+// than std::hardware_destructive_interference_size so the value is stable
+// across compilers and translation units.
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Layout policies for Queue and RingBuf.
+//
+// CompactLayout keeps the indices and slots tightly packed, which minimises
+// memory footprint. PaddedLayout gives the producer and consumer indices their
+// own cache lines and pads each slot to a full line so that neighbouring slots
+// touched by different threads never share a line.
+struct CompactLayout {
+    static constexpr size_t index_align = alignof(std::atomic_size_t);
+    static constexpr size_t slot_align = 1U;
+};
+
+struct PaddedLayout {
+    static constexpr size_t index_align = CACHE_LINE_SIZE;
+    static constexpr size_t slot_align = CACHE_LINE_SIZE;
+};
+
+#endif
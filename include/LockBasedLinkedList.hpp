@@ -3,47 +3,83 @@
 
 #include <iostream>
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <thread>
 #include <vector>
 #include <mutex>
 #include <chrono>
 
-struct Node {
-    int key;
-    void* value;
-    std::shared_ptr<Node> next;
-
-    Node(int k, void* v = nullptr) : key(k), value(v), next(nullptr) {}
-};
+#include "NodePool.hpp"
 
 // Lock-Based Linked List
+//
+// Same interface as LinkedList: an ordered map from Key to an inline Value,
+// starting at a keyless head link and ending at nullptr. Nodes come from the
+// Allocator policy.
+template <typename Key = int, typename Value = void*, typename Compare = std::less<Key>,
+          typename Allocator = NewAllocator>
 class LockBasedLinkedList {
 public:
-    LockBasedLinkedList();
-    bool insert(int k, void* value);
-    bool deleteNode(int k);
-    bool search(int key);
+    LockBasedLinkedList() = default;
+    ~LockBasedLinkedList();
+    LockBasedLinkedList(const LockBasedLinkedList&) = delete;
+    LockBasedLinkedList& operator=(const LockBasedLinkedList&) = delete;
+    bool insert(const Key& k, const Value& value);
+    bool deleteNode(const Key& k);
+    bool search(const Key& key);
+    bool find(const Key& key, Value& value);
     void print() const;
 
+    // Same as LinkedList, but the whole sweep holds the list mutex.
+    template <typename Callback>
+    size_t range_scan(const Key& lo, const Key& hi, Callback&& callback);
+    size_t collect(const Key& lo, const Key& hi, std::vector<std::pair<Key, Value>>& out);
+
 private:
-    std::shared_ptr<Node> head;
+    struct Node;
+
+    struct Link {
+        Node* next = nullptr;
+    };
+
+    struct Node : Link {
+        Key key;
+        Value value;
+
+        Node(const Key& k, const Value& v) : key(k), value(v) {}
+    };
+
+    Link head;
+    [[no_unique_address]] Compare less;
     mutable std::mutex list_mutex; // Mutex for thread safety
 
-    // Helper function to find the node just before the target node
-    std::pair<std::shared_ptr<Node>, std::shared_ptr<Node>> searchFrom(int k);
+    // Helper function to find the link just before the target node
+    std::pair<Link*, Node*> searchFrom(const Key& k);
+
+    bool matches(const Node* node, const Key& k) const {
+        return node != nullptr && !less(k, node->key);
+    }
 };
 
-LockBasedLinkedList::LockBasedLinkedList() {
-    head = std::make_shared<Node>(std::numeric_limits<int>::min());
-    head->next = std::make_shared<Node>(std::numeric_limits<int>::max());
+template <typename Key, typename Value, typename Compare, typename Allocator>
+LockBasedLinkedList<Key, Value, Compare, Allocator>::~LockBasedLinkedList() {
+    Node* curr = head.next;
+    while (curr != nullptr) {
+        Node* next = curr->next;
+        Allocator::destroy(curr);
+        curr = next;
+    }
 }
 
-std::pair<std::shared_ptr<Node>, std::shared_ptr<Node>> LockBasedLinkedList::searchFrom(int k) {
-    auto curr = head;
-    auto next = curr->next;
+template <typename Key, typename Value, typename Compare, typename Allocator>
+std::pair<typename LockBasedLinkedList<Key, Value, Compare, Allocator>::Link*,
+          typename LockBasedLinkedList<Key, Value, Compare, Allocator>::Node*>
+LockBasedLinkedList<Key, Value, Compare, Allocator>::searchFrom(const Key& k) {
+    Link* curr = &head;
+    Node* next = curr->next;
 
-    while (next->key < k) {
+    while (next != nullptr && less(next->key, k)) {
         curr = next;
         next = curr->next;
     }
@@ -51,44 +87,80 @@ std::pair<std::shared_ptr<Node>, std::shared_ptr<Node>> LockBasedLinkedList::sea
     return {curr, next};
 }
 
-bool LockBasedLinkedList::insert(int k, void* value) {
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool LockBasedLinkedList<Key, Value, Compare, Allocator>::insert(const Key& k, const Value& value) {
     std::lock_guard<std::mutex> lock(list_mutex); // Locking critical section
 
     auto [prev, next] = searchFrom(k);
 
-    if (next->key == k) return false; // If the key exists, return false
+    if (matches(next, k)) return false; // If the key exists, return false
 
-    auto newNode = std::make_shared<Node>(k, value);
-    newNode->next = next;
+    Node* newNode = Allocator::template create<Node>(k, value);
+    newNode->next = prev->next;
 
     prev->next = newNode; // Insert new node
 
     return true;
 }
 
-bool LockBasedLinkedList::deleteNode(int k) {
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool LockBasedLinkedList<Key, Value, Compare, Allocator>::deleteNode(const Key& k) {
     std::lock_guard<std::mutex> lock(list_mutex); // Locking critical section
 
     auto [prev, delNode] = searchFrom(k);
-    if (delNode->key != k) return false; // Node not found
+    if (!matches(delNode, k)) return false; // Node not found
 
     prev->next = delNode->next; // Remove the node from the list
+    Allocator::destroy(delNode);
 
     return true;
 }
 
-bool LockBasedLinkedList::search(int key) {
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool LockBasedLinkedList<Key, Value, Compare, Allocator>::search(const Key& key) {
     std::lock_guard<std::mutex> lock(list_mutex); // Locking critical section
 
     auto [prev, next] = searchFrom(key);
-    return next->key == key;
+    return matches(next, key);
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool LockBasedLinkedList<Key, Value, Compare, Allocator>::find(const Key& key, Value& value) {
+    std::lock_guard<std::mutex> lock(list_mutex); // Locking critical section
+
+    auto [prev, next] = searchFrom(key);
+    if (!matches(next, key)) return false;
+
+    value = next->value;
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename Callback>
+size_t LockBasedLinkedList<Key, Value, Compare, Allocator>::range_scan(const Key& lo, const Key& hi,
+                                                                       Callback&& callback) {
+    std::lock_guard<std::mutex> lock(list_mutex); // Locking critical section
+
+    size_t visited = 0;
+    for (Node* curr = searchFrom(lo).second; curr != nullptr && less(curr->key, hi); curr = curr->next) {
+        callback(static_cast<const Key&>(curr->key), static_cast<const Value&>(curr->value));
+        ++visited;
+    }
+    return visited;
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t LockBasedLinkedList<Key, Value, Compare, Allocator>::collect(const Key& lo, const Key& hi,
+                                                                    std::vector<std::pair<Key, Value>>& out) {
+    return range_scan(lo, hi, [&out](const Key& key, const Value& value) { out.emplace_back(key, value); });
 }
 
-void LockBasedLinkedList::print() const {
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void LockBasedLinkedList<Key, Value, Compare, Allocator>::print() const {
     std::lock_guard<std::mutex> lock(list_mutex); // Locking critical section
 
-    auto curr = head->next;
-    while (curr->key != std::numeric_limits<int>::max()) {
+    const Node* curr = head.next;
+    while (curr != nullptr) {
         std::cout << curr->key << "\t";
         curr = curr->next;
     }
@@ -97,4 +169,4 @@ void LockBasedLinkedList::print() const {
 
 
 
-#endif
\ No newline at end of file
+#endif
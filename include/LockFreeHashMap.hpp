@@ -0,0 +1,304 @@
+#ifndef LOCK_FREE_HASH_MAP_HPP
+#define LOCK_FREE_HASH_MAP_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "EpochReclaimer.hpp"
+#include "HarrisList.hpp"
+#include "HazardPointers.hpp"
+#include "Layout.hpp"
+#include "MarkedPointer.hpp"
+
+// Lock-free hash map using split-ordered lists (Shalev / Shavit).
+//
+// All entries live in a single Harris / Michael ordered list, run by the
+// HarrisList loops that LinkedList uses too. The list is sorted by split-order key: the bit-reversed
+// hash, so that the entries of bucket b (mod 2^i) stay contiguous at every
+// table size 2^i. Every bucket is a permanent sentinel node inside that list.
+// The bucket table only holds shortcuts into it.
+//
+// Resizing never moves an entry. Doubling the bucket count is one CAS. A new
+// bucket's sentinel is spliced in lazily by the first operation that needs it,
+// starting from its parent bucket (the same index with the top bit cleared),
+// which already covers the new bucket's range of the list. The table is a
+// fixed array of segments that are allocated on first use, so growing it
+// never copies or blocks.
+//
+// Reclamation is the same policy as LinkedList. Sentinels are never removed,
+// so a bucket shortcut is always safe to start a traversal from, and the
+// UINT64_MAX tail sentinel stops every search before the end of the list.
+template <typename Reclaimer = EpochReclaimer>
+class HashMap {
+public:
+    HashMap();
+    ~HashMap();
+    HashMap(const HashMap&) = delete;
+    HashMap& operator=(const HashMap&) = delete;
+
+    bool insert(int k, void* value);
+    bool upsert(int k, void* value);
+    bool erase(int k);
+    bool find(int k, void*& value);
+
+    // LinkedList-compatible names
+    bool deleteNode(int k) { return erase(k); }
+    bool search(int k) {
+        void* value;
+        return find(k, value);
+    }
+
+    // Approximate while other threads are modifying the map.
+    size_t size() const;
+    size_t bucketCount() const { return numBuckets.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t MIN_BUCKETS = 16U;
+    static constexpr size_t MAX_BUCKETS = size_t(1) << 30;
+    static constexpr size_t SEGMENTS = std::bit_width(MAX_BUCKETS / MIN_BUCKETS);
+    static constexpr size_t MAX_LOAD = 2U;
+    static constexpr size_t COUNTER_STRIPES = 16U;
+    static constexpr long GROW_CHECK_INTERVAL = 8;
+
+    struct Node : ListLink<Node> {
+        uint64_t soKey;
+        int key;
+        std::atomic<void*> value;
+
+        Node(uint64_t so, int k = 0, void* v = nullptr) : soKey(so), key(k), value(v) {}
+
+        static void destroy(void* node) { delete static_cast<Node*>(node); }
+    };
+
+    // Element counts are striped per thread so inserts do not all hit one
+    // cache line; the sum is only needed when deciding whether to grow.
+    struct alignas(CACHE_LINE_SIZE) Counter {
+        std::atomic<long> count{0};
+    };
+
+    using Guard = typename Reclaimer::Guard;
+
+    Node* head; // Sentinel of bucket 0
+    HarrisList<Node, Reclaimer> list;
+    std::atomic<std::atomic<Node*>*> segments[SEGMENTS];
+    std::atomic_size_t numBuckets;
+    Counter counters[COUNTER_STRIPES];
+
+    static uint32_t hash(int k);
+    static uint64_t regularKey(uint32_t h) { return reverseBits((uint64_t(1) << 63) | h); }
+    static uint64_t sentinelKey(size_t bucket) { return reverseBits(bucket); }
+    static uint64_t reverseBits(uint64_t x);
+
+    std::atomic<Node*>& bucketSlot(size_t bucket);
+    Node* getBucket(size_t bucket, Guard& guard);
+    Node* initializeBucket(size_t bucket, Guard& guard);
+    void addCount(long delta);
+
+    // Predicates locating split-order key so for the HarrisList loops.
+    static auto before(uint64_t so) {
+        return [so](const Node* node) { return node->soKey < so; };
+    }
+    static auto matching(uint64_t so) {
+        return [so](const Node* node) { return node->soKey == so; };
+    }
+};
+
+template <typename Reclaimer>
+HashMap<Reclaimer>::HashMap() : numBuckets(MIN_BUCKETS) {
+    for (auto& segment : segments) {
+        segment.store(nullptr, std::memory_order_relaxed);
+    }
+    head = new Node(sentinelKey(0));
+    head->next.store(new Node(UINT64_MAX), std::memory_order_relaxed);
+    bucketSlot(0).store(head, std::memory_order_relaxed);
+}
+
+template <typename Reclaimer>
+HashMap<Reclaimer>::~HashMap() {
+    Node* curr = head;
+    while (curr != nullptr) {
+        Node* next = Unmarked(curr->next.load(std::memory_order_relaxed));
+        delete curr;
+        curr = next;
+    }
+    for (auto& segment : segments) {
+        delete[] segment.load(std::memory_order_relaxed);
+    }
+}
+
+// Murmur3 finaliser. It is a bijection on 32 bits, so distinct keys never
+// share a split-order key and the list needs no secondary ordering.
+template <typename Reclaimer>
+uint32_t HashMap<Reclaimer>::hash(int k) {
+    uint32_t h = static_cast<uint32_t>(k);
+    h ^= h >> 16;
+    h *= 0x85EBCA6BU;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35U;
+    h ^= h >> 16;
+    return h;
+}
+
+template <typename Reclaimer>
+uint64_t HashMap<Reclaimer>::reverseBits(uint64_t x) {
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    x = ((x >> 8) & 0x00FF00FF00FF00FFULL) | ((x & 0x00FF00FF00FF00FFULL) << 8);
+    x = ((x >> 16) & 0x0000FFFF0000FFFFULL) | ((x & 0x0000FFFF0000FFFFULL) << 16);
+    return (x >> 32) | (x << 32);
+}
+
+// Segment 0 holds buckets [0, MIN_BUCKETS); segment s > 0 holds
+// [MIN_BUCKETS << (s - 1), MIN_BUCKETS << s).
+template <typename Reclaimer>
+std::atomic<typename HashMap<Reclaimer>::Node*>& HashMap<Reclaimer>::bucketSlot(size_t bucket) {
+    size_t index = 0;
+    size_t offset = bucket;
+    size_t length = MIN_BUCKETS;
+    if (bucket >= MIN_BUCKETS) {
+        const size_t width = std::bit_width(bucket);
+        index = width - std::bit_width(MIN_BUCKETS) + 1U;
+        length = size_t(1) << (width - 1U);
+        offset = bucket - length;
+    }
+
+    std::atomic<Node*>* segment = segments[index].load(std::memory_order_acquire);
+    if (segment == nullptr) {
+        auto* fresh = new std::atomic<Node*>[length]();
+        if (segments[index].compare_exchange_strong(segment, fresh,
+                                                    std::memory_order_acq_rel,
+                                                    std::memory_order_acquire)) {
+            segment = fresh;
+        } else {
+            delete[] fresh;
+        }
+    }
+    return segment[offset];
+}
+
+template <typename Reclaimer>
+typename HashMap<Reclaimer>::Node* HashMap<Reclaimer>::getBucket(size_t bucket, Guard& guard) {
+    Node* sentinel = bucketSlot(bucket).load(std::memory_order_acquire);
+    if (sentinel == nullptr) {
+        sentinel = initializeBucket(bucket, guard);
+    }
+    return sentinel;
+}
+
+// Splices the sentinel for bucket into the list after its parent's sentinel.
+// Racing initialisers agree on whichever sentinel made it into the list.
+template <typename Reclaimer>
+typename HashMap<Reclaimer>::Node* HashMap<Reclaimer>::initializeBucket(size_t bucket, Guard& guard) {
+    const size_t parent = bucket & ~(size_t(1) << (std::bit_width(bucket) - 1U));
+    Node* start = getBucket(parent, guard);
+
+    const uint64_t so = sentinelKey(bucket);
+    Node* sentinel = list.insert(start, before(so), matching(so), [so] { return new Node(so); }, guard).first;
+
+    bucketSlot(bucket).store(sentinel, std::memory_order_release);
+    return sentinel;
+}
+
+template <typename Reclaimer>
+void HashMap<Reclaimer>::addCount(long delta) {
+    static std::atomic_size_t nextStripe{0};
+    static thread_local size_t stripe =
+        nextStripe.fetch_add(1, std::memory_order_relaxed) % COUNTER_STRIPES;
+
+    const long local = counters[stripe].count.fetch_add(delta, std::memory_order_relaxed) + delta;
+    if (delta < 0 || local % GROW_CHECK_INTERVAL != 0) {
+        return;
+    }
+
+    size_t buckets = numBuckets.load(std::memory_order_relaxed);
+    if (buckets < MAX_BUCKETS && size() > buckets * MAX_LOAD) {
+        numBuckets.compare_exchange_strong(buckets, buckets * 2U, std::memory_order_relaxed);
+    }
+}
+
+template <typename Reclaimer>
+size_t HashMap<Reclaimer>::size() const {
+    long total = 0;
+    for (const auto& counter : counters) {
+        total += counter.count.load(std::memory_order_relaxed);
+    }
+    return total > 0 ? static_cast<size_t>(total) : 0U;
+}
+
+template <typename Reclaimer>
+bool HashMap<Reclaimer>::insert(int k, void* value) {
+    Guard guard;
+    const uint32_t h = hash(k);
+    const uint64_t so = regularKey(h);
+    Node* start = getBucket(h & (numBuckets.load(std::memory_order_acquire) - 1U), guard);
+
+    auto make = [so, k, value] { return new Node(so, k, value); };
+    if (!list.insert(start, before(so), matching(so), make, guard).second) {
+        return false;
+    }
+    addCount(1);
+    return true;
+}
+
+// Inserts k, or replaces the value of an existing k. Returns true if k was
+// inserted.
+template <typename Reclaimer>
+bool HashMap<Reclaimer>::upsert(int k, void* value) {
+    Guard guard;
+    const uint32_t h = hash(k);
+    const uint64_t so = regularKey(h);
+    Node* start = getBucket(h & (numBuckets.load(std::memory_order_acquire) - 1U), guard);
+
+    auto make = [so, k, value] { return new Node(so, k, value); };
+    while (true) {
+        auto [node, inserted] = list.insert(start, before(so), matching(so), make, guard);
+        if (inserted) {
+            addCount(1);
+            return true;
+        }
+
+        // The store only counts if the node was still live after it: an
+        // erase that marked the node first has already removed k, so
+        // search again and insert it afresh. Both accesses are seq_cst
+        // so the check cannot be reordered before the store.
+        node->value.store(value);
+        if (!IsMarked(node->next.load())) {
+            return false;
+        }
+    }
+}
+
+template <typename Reclaimer>
+bool HashMap<Reclaimer>::erase(int k) {
+    Guard guard;
+    const uint32_t h = hash(k);
+    const uint64_t so = regularKey(h);
+    Node* start = getBucket(h & (numBuckets.load(std::memory_order_acquire) - 1U), guard);
+
+    if (!list.remove(start, before(so), matching(so), guard)) {
+        return false;
+    }
+    addCount(-1);
+    return true;
+}
+
+template <typename Reclaimer>
+bool HashMap<Reclaimer>::find(int k, void*& value) {
+    Guard guard;
+    const uint32_t h = hash(k);
+    const uint64_t so = regularKey(h);
+    Node* start = getBucket(h & (numBuckets.load(std::memory_order_acquire) - 1U), guard);
+
+    auto [prev, curr] = list.search(start, before(so), guard);
+    if (curr->soKey != so) {
+        return false;
+    }
+    value = curr->value.load(std::memory_order_acquire);
+    return true;
+}
+
+#endif
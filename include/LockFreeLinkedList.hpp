@@ -3,103 +3,371 @@
 
 #include <iostream>
 #include <atomic>
+#include <functional>
+#include <iterator>
 #include <memory>
-#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <mutex>
-#include <chrono>
-
 
+#include "Backoff.hpp"
+#include "ContentionStats.hpp"
+#include "EpochReclaimer.hpp"
+#include "HarrisList.hpp"
+#include "HazardPointers.hpp"
+#include "MarkedPointer.hpp"
+#include "NodePool.hpp"
+#include "Platform.hpp"
 
+// Lock-free ordered map (Harris / Michael) from Key to Value, ordered by
+// Compare.
+//
+// Nodes are linked through raw atomic pointers. Deletion is two-step: the
+// victim's next pointer is marked first (logical delete), which freezes it so
+// no insert can land behind a dying node, and only then is the victim unlinked
+// from its predecessor. Traversals in searchFrom help by unlinking any marked
+// node they meet. The search, insert and delete loops live in HarrisList,
+// which HashMap shares.
+//
+// Memory reclamation is a policy. With HazardPointers (the default),
+// traversals publish the two nodes they stand on (prev and curr) and
+// re-validate the link before touching them. With EpochReclaimer, a whole
+// operation runs inside one epoch critical section and hops cost nothing
+// extra. Either way, unlinked nodes are retired to the reclaimer, and no
+// shared reference counts are touched while walking the list.
+//
+// Values are stored inline in the node, so a hit needs no further pointer
+// chase; they must be trivially copyable since readers copy them out while
+// the node may be unlinked concurrently. The list starts at a keyless head
+// link and ends at nullptr, so Key needs no minimum or maximum value.
+//
+// Nodes are created and destroyed through the Allocator policy; PoolAllocator
+// serves them from per-thread NodePool magazines instead of the global heap.
+//
+// StatsPolicy counts insert, deleteNode, search and find calls and the lost
+// CASes and restarts of every search; see ContentionStats.hpp. Backoff paces
+// the retries after a lost CAS; see Backoff.hpp. With the defaults, NoStats
+// and NoBackoff, neither costs anything.
+//
+// Ordered traversal (Iterator, range_scan, collect) runs concurrently with
+// writers and is weakly consistent: keys come out in strictly increasing
+// order, each at most once; every key present for the whole traversal is
+// visited; a key inserted or deleted during the traversal may or may not be.
+// An iterator keeps a reclamation guard for its lifetime, so with
+// EpochReclaimer a long-lived iterator holds back reclamation.
+template <typename Key = int, typename Value = void*, typename Compare = std::less<Key>,
+          typename Reclaimer = HazardPointers, typename Allocator = NewAllocator,
+          typename StatsPolicy = NoStats, typename Backoff = NoBackoff>
 class LinkedList {
+    static_assert(std::is_trivially_copyable_v<Value>, "Value is stored inline and must be trivially copyable");
+
 public:
-    LinkedList();
-    std::shared_ptr<Node> search(int key);
-    bool insert(int k, void* value);
-    bool deleteNode(int k);
+    LinkedList() = default;
+    ~LinkedList();
+    LinkedList(const LinkedList&) = delete;
+    LinkedList& operator=(const LinkedList&) = delete;
+
+    bool search(const Key& key);
+    bool find(const Key& key, Value& value);
+    bool insert(const Key& k, const Value& value);
+    bool deleteNode(const Key& k);
     void print() const;
     void destroy();
 
+    // Sums the per-thread counters; all zero unless StatsPolicy is enabled.
+    StatsSnapshot stats() const { return core.contention.Snapshot(); }
+
+    class Iterator;
+
+    Iterator begin();
+    Iterator end() { return Iterator(); }
+    // First element with key >= k.
+    Iterator lower_bound(const Key& k);
+
+    // Calls callback(key, value) for every element with lo <= key < hi.
+    // Returns the number of elements visited.
+    template <typename Callback>
+    size_t range_scan(const Key& lo, const Key& hi, Callback&& callback);
+
+    // Appends every element with lo <= key < hi to out in one pass under a
+    // single guard, prefetching the next node while the current one is
+    // copied. Returns the number appended.
+    size_t collect(const Key& lo, const Key& hi, std::vector<std::pair<Key, Value>>& out);
+
 private:
-    std::shared_ptr<Node> head;
-    std::pair<std::shared_ptr<Node>, std::shared_ptr<Node>> searchFrom(int k);
+    struct Node : ListLink<Node> {
+        Key key;
+        Value value;
+
+        Node(const Key& k, const Value& v) : key(k), value(v) {}
+
+        static void destroy(void* node) {
+            Allocator::destroy(static_cast<Node*>(node));
+        }
+    };
+
+    using Core = HarrisList<Node, Reclaimer, StatsPolicy, Backoff>;
+    // The part of a node that searchFrom can stand on; head is one too.
+    using Link = typename Core::Link;
+    using Guard = typename Reclaimer::Guard;
+
+    static constexpr size_t HP_PREV = Core::HP_PREV;
+    static constexpr size_t HP_CURR = Core::HP_CURR;
+
+    Link head;
+    [[no_unique_address]] Compare less;
+    Core core;
+
+    bool matches(const Node* node, const Key& k) const {
+        return node != nullptr && !less(k, node->key);
+    }
+
+    // Predicates locating k for the HarrisList loops.
+    auto before(const Key& k) const {
+        return [this, &k](const Node* node) { return less(node->key, k); };
+    }
+    auto matching(const Key& k) const {
+        return [this, &k](const Node* node) { return matches(node, k); };
+    }
+
+    // Finds the first node with key >= k (nullptr at the end of the list) and
+    // the link before it, unlinking marked nodes on the way. Both were
+    // adjacent and unmarked at some point during the call, and stay protected
+    // by guard on return.
+    std::pair<Link*, Node*> searchFrom(const Key& k, Guard& guard);
+
+    // Returns the first unmarked node after link (nullptr at the end), which
+    // must be protected in HP_PREV, and leaves the result protected in
+    // HP_PREV. If link's node has been deleted meanwhile, its successor may
+    // already be retired, so the walk re-seeks from the head past its key.
+    Node* successor(Link* link, Guard& guard);
 };
 
-LinkedList::LinkedList() {
-    head = std::make_shared<Node>(std::numeric_limits<int>::min());
-    head->next = std::make_shared<Node>(std::numeric_limits<int>::max());
-}
+// Move-only input iterator over a LinkedList; see the class comment for its
+// consistency guarantee. Dereferencing yields (key, value) references into
+// the current node, valid until the iterator is advanced or destroyed.
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+class LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::Iterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::pair<Key, Value>;
+    using difference_type = std::ptrdiff_t;
 
-std::pair<std::shared_ptr<Node>, std::shared_ptr<Node>> LinkedList::searchFrom(int k) {
-    auto curr = head;
-    auto next = curr->next;
+    Iterator() = default;
+    Iterator(Iterator&&) noexcept = default;
+    Iterator& operator=(Iterator&&) noexcept = default;
 
-    // Traverse the list, check for nullptr before accessing next->key
-    while (next && next->key <= k) {
-        if (next->key == k) return {curr, next};
-        curr = next;
-        next = curr->next;
+    const Key& key() const { return node->key; }
+    const Value& value() const { return node->value; }
+    std::pair<const Key&, const Value&> operator*() const { return {node->key, node->value}; }
+
+    Iterator& operator++() {
+        node = list->successor(node, *guard);
+        return *this;
     }
 
-    return {curr, next};
+    bool operator==(const Iterator& other) const { return node == other.node; }
+
+private:
+    friend class LinkedList;
+
+    Iterator(LinkedList* l, std::unique_ptr<Guard> g, Node* n) : list(l), guard(std::move(g)), node(n) {}
+
+    LinkedList* list = nullptr;
+    std::unique_ptr<Guard> guard;
+    Node* node = nullptr;
+};
+
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::~LinkedList() {
+    destroy();
 }
 
-bool LinkedList::insert(int k, void* value) {
-    auto [prev, next] = searchFrom(k);
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+std::pair<typename LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::Link*,
+          typename LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::Node*>
+LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::searchFrom(const Key& k, Guard& guard) {
+    return core.search(&head, before(k), guard);
+}
 
-    // Ensure next is not null before dereferencing
-    if (next && next->key == k) return false;
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+bool LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::insert(
+    const Key& k, const Value& value) {
+    Guard guard;
+    core.contention.Add(Stat::OPERATIONS);
 
-    auto newNode = std::make_shared<Node>(k, value);
-    newNode->next = next;
+    // Fails if the key exists.
+    auto make = [&k, &value] { return Allocator::template create<Node>(k, value); };
+    return core.insert(&head, before(k), matching(k), make, guard).second;
+}
 
-    if (std::atomic_compare_exchange_strong(&prev->next, &next, newNode)) {
-        return true;
-    }
-    return false;
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+bool LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::deleteNode(const Key& k) {
+    Guard guard;
+    core.contention.Add(Stat::OPERATIONS);
+
+    return core.remove(&head, before(k), matching(k), guard);
 }
 
-bool LinkedList::deleteNode(int k) {
-    auto [prev, delNode] = searchFrom(k);
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+bool LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::search(const Key& key) {
+    Guard guard;
+    core.contention.Add(Stat::OPERATIONS);
+
+    auto [prev, curr] = searchFrom(key, guard);
+    return matches(curr, key);
+}
 
-    // Ensure delNode is not null before dereferencing
-    if (!delNode || delNode->key != k) return false;
+// Copies the value stored for key out of its node.
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+bool LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::find(const Key& key, Value& value) {
+    Guard guard;
+    core.contention.Add(Stat::OPERATIONS);
 
-    if (std::atomic_compare_exchange_strong(&prev->next, &delNode, delNode->next)) {
-        return true;
+    auto [prev, curr] = searchFrom(key, guard);
+    if (!matches(curr, key)) {
+        return false;
     }
-    return false;
+    value = curr->value;
+    return true;
 }
 
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+typename LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::Node*
+LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::successor(Link* link, Guard& guard) {
+    while (true) {
+        Node* next = link->next.load(std::memory_order_acquire);
+
+        if (IsMarked(next)) {
+            // The head is never marked, so link is a deleted node.
+            const Key key = static_cast<Node*>(link)->key;
+            auto [prev, curr] = searchFrom(key, guard);
+            guard.protect(HP_PREV, curr);
+            if (!matches(curr, key)) {
+                return curr;
+            }
+            link = curr; // Re-inserted with the same key; already visited
+            continue;
+        }
+        if (next == nullptr) {
+            return nullptr;
+        }
+
+        if constexpr (Reclaimer::PROTECTS_POINTERS) {
+            guard.protect(HP_CURR, next);
+            if (link->next.load(std::memory_order_acquire) != next) {
+                continue;
+            }
+        }
+
+        Node* after = next->next.load(std::memory_order_acquire);
+        if (IsMarked(after)) {
+            // Help unlink the deleted node, as searchFrom does, and retry.
+            Node* expected = next;
+            if (link->next.compare_exchange_strong(expected, Unmarked(after),
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_acquire)) {
+                guard.retire(next, &Node::destroy);
+            }
+            continue;
+        }
 
-void LinkedList::print() const {
-    auto curr = head->next;
-    while (curr->key != std::numeric_limits<int>::max()) {
-        std::cout << curr->key << "\t";
-        curr = curr->next;
+        guard.protect(HP_PREV, next);
+        return next;
     }
-    std::cout << std::endl;
 }
 
-void LinkedList::destroy() {
-    auto curr = head;
-    while (curr) {
-        curr = curr->next;
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+typename LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::Iterator
+LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::begin() {
+    auto guard = std::make_unique<Guard>();
+    Node* first = successor(&head, *guard);
+    return first != nullptr ? Iterator(this, std::move(guard), first) : Iterator();
+}
+
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+typename LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::Iterator
+LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::lower_bound(const Key& k) {
+    auto guard = std::make_unique<Guard>();
+    auto [prev, curr] = searchFrom(k, *guard);
+    guard->protect(HP_PREV, curr);
+    return curr != nullptr ? Iterator(this, std::move(guard), curr) : Iterator();
+}
+
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+template <typename Callback>
+size_t LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::range_scan(
+    const Key& lo, const Key& hi, Callback&& callback) {
+    Guard guard;
+    size_t visited = 0;
+
+    auto [prev, curr] = searchFrom(lo, guard);
+    guard.protect(HP_PREV, curr);
+    while (curr != nullptr && less(curr->key, hi)) {
+        callback(static_cast<const Key&>(curr->key), static_cast<const Value&>(curr->value));
+        ++visited;
+        curr = successor(curr, guard);
     }
+    return visited;
 }
 
-std::shared_ptr<Node> LinkedList::search(int key) {
-    std::shared_ptr<Node> current = head;  // Start with the head of the list
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+size_t LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::collect(
+    const Key& lo, const Key& hi, std::vector<std::pair<Key, Value>>& out) {
+    Guard guard;
+    const size_t before = out.size();
 
-    while (current != nullptr) {
-        if (current->key == key) {
-            return current;  // Return the node if found
+    auto [prev, curr] = searchFrom(lo, guard);
+    guard.protect(HP_PREV, curr);
+    while (curr != nullptr && less(curr->key, hi)) {
+        // Start pulling in the next node before spending time on this one.
+        Prefetch(Unmarked(curr->next.load(std::memory_order_relaxed)));
+        out.emplace_back(curr->key, curr->value);
+        curr = successor(curr, guard);
+    }
+    return out.size() - before;
+}
+
+// Diagnostic dump; must not run concurrently with deleteNode.
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+void LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::print() const {
+    Node* curr = Unmarked(head.next.load(std::memory_order_acquire));
+    while (curr != nullptr) {
+        Node* next = curr->next.load(std::memory_order_acquire);
+        if (!IsMarked(next)) {
+            std::cout << curr->key << "\t";
         }
-        current = current->next;  // Move to the next node
+        curr = Unmarked(next);
     }
+    std::cout << std::endl;
+}
 
-    return nullptr;  // Return nullptr if key is not found
+// Frees every element. Must not run concurrently with any other operation on
+// the list. Nodes already retired are left to the reclaimer.
+template <typename Key, typename Value, typename Compare, typename Reclaimer, typename Allocator,
+          typename StatsPolicy, typename Backoff>
+void LinkedList<Key, Value, Compare, Reclaimer, Allocator, StatsPolicy, Backoff>::destroy() {
+    Node* curr = Unmarked(head.next.load(std::memory_order_relaxed));
+    while (curr != nullptr) {
+        Node* next = Unmarked(curr->next.load(std::memory_order_relaxed));
+        Allocator::destroy(curr);
+        curr = next;
+    }
+    head.next.store(nullptr, std::memory_order_relaxed);
 }
 
 
-#endif
\ No newline at end of file
+#endif
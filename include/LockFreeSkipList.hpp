@@ -0,0 +1,334 @@
+#ifndef LOCK_FREE_SKIP_LIST_HPP
+#define LOCK_FREE_SKIP_LIST_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+#include "Backoff.hpp"
+#include "EpochReclaimer.hpp"
+#include "MarkedPointer.hpp"
+
+// Lock-free skip list (Herlihy / Lev / Luchangco / Shavit) with the same
+// int key / void* value interface as LinkedList, and O(log n) expected cost
+// per operation.
+//
+// Each node gets a random tower height. A node is inserted by linking it at
+// the bottom level, which is the linearisation point, after which the upper
+// levels are linked lazily. Deletion marks every level of the victim top-down
+// and the bottom-level mark decides the winner. find() snips marked nodes it
+// passes, exactly like LinkedList::searchFrom does on a single level.
+//
+// The inserter may still be linking upper levels when the node is deleted,
+// so a node is only retired once both the inserter and the deleter are done
+// with it (see Node::owners); whichever finishes last unlinks any remaining
+// levels and retires it. Traversals of unlinked towers are only safe when a
+// whole operation runs inside one critical section, so reclamation must be an
+// epoch-style policy.
+//
+// Backoff paces the retries after a lost CAS; see Backoff.hpp.
+template <typename Reclaimer = EpochReclaimer, typename Backoff = NoBackoff>
+class SkipList {
+    static_assert(!Reclaimer::PROTECTS_POINTERS,
+                  "SkipList needs an epoch-style reclaimer");
+
+public:
+    static constexpr int MAX_LEVEL = 24;
+
+    SkipList();
+    ~SkipList();
+    SkipList(const SkipList&) = delete;
+    SkipList& operator=(const SkipList&) = delete;
+
+    bool insert(int k, void* value);
+    bool erase(int k);
+    bool contains(int k);
+    bool find(int k, void*& value);
+
+    // LinkedList-compatible names
+    bool deleteNode(int k) { return erase(k); }
+    bool search(int k) { return contains(k); }
+
+private:
+    struct Node {
+        int key;
+        void* value;
+        int height;
+        // Inserter + deleter; the one that drops this to zero retires the node.
+        std::atomic<int> owners;
+
+        // The tower of `height` next pointers is laid out right after the node.
+        std::atomic<Node*>& next(int level) {
+            return reinterpret_cast<std::atomic<Node*>*>(this + 1)[level];
+        }
+
+        static Node* create(int key, void* value, int height);
+        static void destroy(void* node);
+    };
+
+    using Guard = typename Reclaimer::Guard;
+
+    Node* head;
+    Node* tail;
+
+    bool findNode(int k, Node** preds, Node** succs);
+    Node* findUnlinked(int k);
+    static int randomLevel();
+};
+
+template <typename Reclaimer, typename Backoff>
+typename SkipList<Reclaimer, Backoff>::Node* SkipList<Reclaimer, Backoff>::Node::create(int key, void* value,
+                                                                                     int height) {
+    void* memory = ::operator new(sizeof(Node) + height * sizeof(std::atomic<Node*>));
+    Node* node = static_cast<Node*>(memory);
+    node->key = key;
+    node->value = value;
+    node->height = height;
+    new (&node->owners) std::atomic<int>(2);
+    for (int level = 0; level < height; ++level) {
+        new (&node->next(level)) std::atomic<Node*>(nullptr);
+    }
+    return node;
+}
+
+template <typename Reclaimer, typename Backoff>
+void SkipList<Reclaimer, Backoff>::Node::destroy(void* node) {
+    ::operator delete(node);
+}
+
+template <typename Reclaimer, typename Backoff>
+SkipList<Reclaimer, Backoff>::SkipList() {
+    head = Node::create(std::numeric_limits<int>::min(), nullptr, MAX_LEVEL);
+    tail = Node::create(std::numeric_limits<int>::max(), nullptr, MAX_LEVEL);
+    for (int level = 0; level < MAX_LEVEL; ++level) {
+        head->next(level).store(tail, std::memory_order_relaxed);
+    }
+}
+
+template <typename Reclaimer, typename Backoff>
+SkipList<Reclaimer, Backoff>::~SkipList() {
+    Node* curr = Unmarked(head->next(0).load(std::memory_order_relaxed));
+    while (curr != tail) {
+        Node* next = Unmarked(curr->next(0).load(std::memory_order_relaxed));
+        Node::destroy(curr);
+        curr = next;
+    }
+    Node::destroy(head);
+    Node::destroy(tail);
+}
+
+// Fills preds/succs with the nodes around k on every level, snipping marked
+// nodes on the way. Returns true if an unmarked node with key k was found on
+// the bottom level. The sentinels' keys are only there to stop traversals, so
+// head and tail are told apart by address: INT_MIN and INT_MAX are ordinary
+// keys.
+template <typename Reclaimer, typename Backoff>
+bool SkipList<Reclaimer, Backoff>::findNode(int k, Node** preds, Node** succs) {
+    Backoff backoff;
+retry:
+    Node* pred = head;
+    for (int level = MAX_LEVEL - 1; level >= 0; --level) {
+        Node* curr = Unmarked(pred->next(level).load(std::memory_order_acquire));
+        while (true) {
+            Node* succ = curr->next(level).load(std::memory_order_acquire);
+            while (IsMarked(succ)) {
+                Node* expected = curr;
+                if (!pred->next(level).compare_exchange_strong(expected, Unmarked(succ),
+                                                               std::memory_order_acq_rel,
+                                                               std::memory_order_acquire)) {
+                    backoff.Pause();
+                    goto retry;
+                }
+                curr = Unmarked(succ);
+                succ = curr->next(level).load(std::memory_order_acquire);
+            }
+            if (curr->key < k) {
+                pred = curr;
+                curr = succ;
+            } else {
+                break;
+            }
+        }
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+    return succs[0] != tail && succs[0]->key == k;
+}
+
+// Runs a snipping traversal for k so that a deleted node with that key is no
+// longer linked on any level.
+template <typename Reclaimer, typename Backoff>
+typename SkipList<Reclaimer, Backoff>::Node* SkipList<Reclaimer, Backoff>::findUnlinked(int k) {
+    Node* preds[MAX_LEVEL];
+    Node* succs[MAX_LEVEL];
+    findNode(k, preds, succs);
+    return succs[0];
+}
+
+template <typename Reclaimer, typename Backoff>
+bool SkipList<Reclaimer, Backoff>::insert(int k, void* value) {
+    Guard guard;
+    Node* preds[MAX_LEVEL];
+    Node* succs[MAX_LEVEL];
+    Node* node = nullptr;
+    Backoff backoff;
+
+    while (true) {
+        if (findNode(k, preds, succs)) {
+            if (node != nullptr) {
+                Node::destroy(node);
+            }
+            return false;
+        }
+
+        if (node == nullptr) {
+            node = Node::create(k, value, randomLevel());
+        }
+        for (int level = 0; level < node->height; ++level) {
+            node->next(level).store(succs[level], std::memory_order_relaxed);
+        }
+
+        Node* expected = succs[0];
+        if (preds[0]->next(0).compare_exchange_strong(expected, node,
+                                                      std::memory_order_release,
+                                                      std::memory_order_relaxed)) {
+            break;
+        }
+        backoff.Pause();
+    }
+
+    // Lazily link the upper levels. Give up as soon as the node is deleted.
+    for (int level = 1; level < node->height; ++level) {
+        while (true) {
+            Node* next = node->next(level).load(std::memory_order_acquire);
+            if (IsMarked(next)) {
+                goto linked;
+            }
+            if (next != succs[level] &&
+                !node->next(level).compare_exchange_strong(next, succs[level],
+                                                           std::memory_order_acq_rel,
+                                                           std::memory_order_acquire)) {
+                continue;
+            }
+
+            Node* expected = succs[level];
+            if (preds[level]->next(level).compare_exchange_strong(expected, node,
+                                                                  std::memory_order_release,
+                                                                  std::memory_order_relaxed)) {
+                break;
+            }
+
+            findNode(k, preds, succs);
+            if (succs[0] != node) {
+                goto linked; // Already deleted and unlinked from the bottom level
+            }
+        }
+    }
+
+linked:
+    if (node->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // The deleter finished first; remove whatever levels we linked late.
+        findUnlinked(k);
+        guard.retire(node, &Node::destroy);
+    }
+    return true;
+}
+
+template <typename Reclaimer, typename Backoff>
+bool SkipList<Reclaimer, Backoff>::erase(int k) {
+    Guard guard;
+    Node* preds[MAX_LEVEL];
+    Node* succs[MAX_LEVEL];
+
+    if (!findNode(k, preds, succs)) {
+        return false;
+    }
+    Node* node = succs[0];
+
+    for (int level = node->height - 1; level >= 1; --level) {
+        Node* next = node->next(level).load(std::memory_order_acquire);
+        while (!IsMarked(next) &&
+               !node->next(level).compare_exchange_weak(next, Marked(next),
+                                                        std::memory_order_acq_rel,
+                                                        std::memory_order_acquire)) {
+        }
+    }
+
+    Node* next = node->next(0).load(std::memory_order_acquire);
+    Backoff backoff;
+    while (true) {
+        if (IsMarked(next)) {
+            return false; // Another thread deleted it first
+        }
+        if (node->next(0).compare_exchange_weak(next, Marked(next),
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+            break;
+        }
+        backoff.Pause();
+    }
+
+    if (node->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        findUnlinked(k);
+        guard.retire(node, &Node::destroy);
+    }
+    return true;
+}
+
+template <typename Reclaimer, typename Backoff>
+bool SkipList<Reclaimer, Backoff>::find(int k, void*& value) {
+    Guard guard;
+
+    Node* pred = head;
+    Node* curr = nullptr;
+    for (int level = MAX_LEVEL - 1; level >= 0; --level) {
+        curr = Unmarked(pred->next(level).load(std::memory_order_acquire));
+        while (true) {
+            Node* succ = curr->next(level).load(std::memory_order_acquire);
+            while (IsMarked(succ)) {
+                curr = Unmarked(succ);
+                succ = curr->next(level).load(std::memory_order_acquire);
+            }
+            if (curr->key < k) {
+                pred = curr;
+                curr = succ;
+            } else {
+                break;
+            }
+        }
+    }
+
+    if (curr == tail || curr->key != k) {
+        return false;
+    }
+    value = curr->value;
+    return true;
+}
+
+template <typename Reclaimer, typename Backoff>
+bool SkipList<Reclaimer, Backoff>::contains(int k) {
+    void* value;
+    return find(k, value);
+}
+
+template <typename Reclaimer, typename Backoff>
+int SkipList<Reclaimer, Backoff>::randomLevel() {
+    static thread_local uint64_t state =
+        0x9E3779B97F4A7C15ULL ^ reinterpret_cast<uintptr_t>(&state);
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    // Geometric distribution with p = 1/2, capped at MAX_LEVEL.
+    int level = 1;
+    uint64_t bits = state;
+    while ((bits & 1U) != 0U && level < MAX_LEVEL) {
+        ++level;
+        bits >>= 1;
+    }
+    return level;
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef MARKED_POINTER_HPP
+#define MARKED_POINTER_HPP
+
+#include <cstdint>
+
+// Helpers for Harris-style logical deletion. The low bit of a node's next
+// pointer marks the node itself as deleted; nodes are at least 2-byte aligned,
+// so the bit is otherwise always zero.
+
+template <typename T> inline bool IsMarked(const T *ptr) {
+    return (reinterpret_cast<uintptr_t>(ptr) & 1U) != 0U;
+}
+
+template <typename T> inline T *Marked(T *ptr) {
+    return reinterpret_cast<T *>(reinterpret_cast<uintptr_t>(ptr) | 1U);
+}
+
+template <typename T> inline T *Unmarked(T *ptr) {
+    return reinterpret_cast<T *>(reinterpret_cast<uintptr_t>(ptr) &
+                                 ~static_cast<uintptr_t>(1U));
+}
+
+#endif
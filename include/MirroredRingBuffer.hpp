@@ -0,0 +1,273 @@
+#ifndef MIRRORED_RING_BUF_HPP
+#define MIRRORED_RING_BUF_HPP
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "Layout.hpp"
+
+// Single-producer / single-consumer ring buffer whose storage is mapped twice,
+// back to back, in virtual memory. Element i and element i + Capacity() are the
+// same memory, so any run of up to Capacity() elements starting anywhere in the
+// ring is one contiguous region: no split memcpy at the wrap point, and the
+// zero-copy views are always a single span that can be handed to a parser or
+// writev() directly.
+//
+// The capacity is chosen at runtime and rounded up to a whole number of pages.
+// As with RingBuf, one slot is kept free to tell a full ring from an empty one.
+// Linux only (memfd_create + MAP_FIXED).
+template <typename T, typename Layout = CompactLayout> class MirroredRingBuf {
+    static_assert(std::is_trivial<T>::value, "The type T must be trivial");
+
+  public:
+    explicit MirroredRingBuf(size_t min_capacity);
+    ~MirroredRingBuf();
+    MirroredRingBuf(const MirroredRingBuf &) = delete;
+    MirroredRingBuf &operator=(const MirroredRingBuf &) = delete;
+
+    bool Write(const T *data, size_t cnt);
+    bool Read(T *data, size_t cnt);
+    bool Peek(T *data, size_t cnt) const;
+    bool Skip(size_t cnt);
+    size_t GetFree() const;
+    size_t GetAvailable() const;
+    size_t Capacity() const { return _capacity; }
+
+    // Zero-copy API; the returned spans are always contiguous.
+    std::span<T> WriteReserve(size_t cnt);
+    void WriteCommit(size_t cnt);
+    std::span<const T> ReadAcquire(size_t cnt);
+    void ReadRelease(size_t cnt);
+
+  private:
+    size_t CalcFree(const size_t w, const size_t r) const;
+    size_t CalcAvailable(const size_t w, const size_t r) const;
+    size_t Advance(size_t index, size_t cnt) const;
+
+  private:
+    T *_data;
+    size_t _capacity;
+    size_t _bytes;
+
+    alignas(Layout::index_align) std::atomic_size_t _r;
+    mutable size_t _w_cache;
+
+    alignas(Layout::index_align) std::atomic_size_t _w;
+    size_t _r_cache;
+};
+
+template <typename T, typename Layout>
+MirroredRingBuf<T, Layout>::MirroredRingBuf(const size_t min_capacity)
+    : _data(nullptr), _capacity(0U), _bytes(0U), _r(0U), _w_cache(0U), _w(0U),
+      _r_cache(0U) {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    if (page % sizeof(T) != 0U) {
+        throw std::invalid_argument(
+            "MirroredRingBuf: element size must divide the page size");
+    }
+
+    const size_t wanted = (min_capacity > 2U ? min_capacity : 3U) * sizeof(T);
+    _bytes = (wanted + page - 1U) / page * page;
+    _capacity = _bytes / sizeof(T);
+
+    const int fd = memfd_create("MirroredRingBuf", MFD_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "memfd_create");
+    }
+    if (ftruncate(fd, static_cast<off_t>(_bytes)) != 0) {
+        const int err = errno;
+        close(fd);
+        throw std::system_error(err, std::generic_category(), "ftruncate");
+    }
+
+    // Reserve 2 * _bytes of address space, then map the file over both halves.
+    void *base = mmap(nullptr, 2U * _bytes, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        const int err = errno;
+        close(fd);
+        throw std::system_error(err, std::generic_category(), "mmap");
+    }
+
+    char *bytes = static_cast<char *>(base);
+    for (size_t half = 0U; half < 2U; ++half) {
+        void *view = mmap(bytes + half * _bytes, _bytes, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_FIXED, fd, 0);
+        if (view == MAP_FAILED) {
+            const int err = errno;
+            munmap(base, 2U * _bytes);
+            close(fd);
+            throw std::system_error(err, std::generic_category(), "mmap");
+        }
+    }
+    close(fd);
+
+    _data = reinterpret_cast<T *>(base);
+}
+
+template <typename T, typename Layout>
+MirroredRingBuf<T, Layout>::~MirroredRingBuf() {
+    munmap(_data, 2U * _bytes);
+}
+
+template <typename T, typename Layout>
+bool MirroredRingBuf<T, Layout>::Write(const T *data, const size_t cnt) {
+    const size_t w = _w.load(std::memory_order_relaxed);
+
+    if (CalcFree(w, _r_cache) < cnt) {
+        _r_cache = _r.load(std::memory_order_acquire);
+        if (CalcFree(w, _r_cache) < cnt) {
+            return false;
+        }
+    }
+
+    memcpy(&_data[w], &data[0], cnt * sizeof(T));
+    _w.store(Advance(w, cnt), std::memory_order_release);
+
+    return true;
+}
+
+template <typename T, typename Layout>
+bool MirroredRingBuf<T, Layout>::Read(T *data, const size_t cnt) {
+    if (!Peek(data, cnt)) {
+        return false;
+    }
+    const size_t r = _r.load(std::memory_order_relaxed);
+    _r.store(Advance(r, cnt), std::memory_order_release);
+
+    return true;
+}
+
+template <typename T, typename Layout>
+bool MirroredRingBuf<T, Layout>::Peek(T *data, const size_t cnt) const {
+    const size_t r = _r.load(std::memory_order_relaxed);
+
+    if (CalcAvailable(_w_cache, r) < cnt) {
+        _w_cache = _w.load(std::memory_order_acquire);
+        if (CalcAvailable(_w_cache, r) < cnt) {
+            return false;
+        }
+    }
+
+    memcpy(&data[0], &_data[r], cnt * sizeof(T));
+
+    return true;
+}
+
+template <typename T, typename Layout>
+bool MirroredRingBuf<T, Layout>::Skip(const size_t cnt) {
+    const size_t r = _r.load(std::memory_order_relaxed);
+
+    if (CalcAvailable(_w_cache, r) < cnt) {
+        _w_cache = _w.load(std::memory_order_acquire);
+        if (CalcAvailable(_w_cache, r) < cnt) {
+            return false;
+        }
+    }
+    _r.store(Advance(r, cnt), std::memory_order_release);
+
+    return true;
+}
+
+template <typename T, typename Layout>
+size_t MirroredRingBuf<T, Layout>::GetFree() const {
+    const size_t w = _w.load(std::memory_order_relaxed);
+    const size_t r = _r.load(std::memory_order_acquire);
+
+    return CalcFree(w, r);
+}
+
+template <typename T, typename Layout>
+size_t MirroredRingBuf<T, Layout>::GetAvailable() const {
+    const size_t r = _r.load(std::memory_order_relaxed);
+    const size_t w = _w.load(std::memory_order_acquire);
+
+    return CalcAvailable(w, r);
+}
+
+template <typename T, typename Layout>
+std::span<T> MirroredRingBuf<T, Layout>::WriteReserve(size_t cnt) {
+    const size_t w = _w.load(std::memory_order_relaxed);
+
+    if (CalcFree(w, _r_cache) < cnt) {
+        _r_cache = _r.load(std::memory_order_acquire);
+        const size_t free = CalcFree(w, _r_cache);
+        if (free < cnt) {
+            cnt = free;
+        }
+    }
+
+    return std::span<T>(&_data[w], cnt);
+}
+
+template <typename T, typename Layout>
+void MirroredRingBuf<T, Layout>::WriteCommit(const size_t cnt) {
+    const size_t w = _w.load(std::memory_order_relaxed);
+    _w.store(Advance(w, cnt), std::memory_order_release);
+}
+
+template <typename T, typename Layout>
+std::span<const T> MirroredRingBuf<T, Layout>::ReadAcquire(size_t cnt) {
+    const size_t r = _r.load(std::memory_order_relaxed);
+
+    if (CalcAvailable(_w_cache, r) < cnt) {
+        _w_cache = _w.load(std::memory_order_acquire);
+        const size_t available = CalcAvailable(_w_cache, r);
+        if (available < cnt) {
+            cnt = available;
+        }
+    }
+
+    return std::span<const T>(&_data[r], cnt);
+}
+
+template <typename T, typename Layout>
+void MirroredRingBuf<T, Layout>::ReadRelease(const size_t cnt) {
+    const size_t r = _r.load(std::memory_order_relaxed);
+    _r.store(Advance(r, cnt), std::memory_order_release);
+}
+
+template <typename T, typename Layout>
+size_t MirroredRingBuf<T, Layout>::CalcFree(const size_t w,
+                                            const size_t r) const {
+    if (r > w) {
+        return (r - w) - 1U;
+    } else {
+        return (_capacity - (w - r)) - 1U;
+    }
+}
+
+template <typename T, typename Layout>
+size_t MirroredRingBuf<T, Layout>::CalcAvailable(const size_t w,
+                                                 const size_t r) const {
+    if (w >= r) {
+        return w - r;
+    } else {
+        return _capacity - (r - w);
+    }
+}
+
+template <typename T, typename Layout>
+size_t MirroredRingBuf<T, Layout>::Advance(size_t index,
+                                           const size_t cnt) const {
+    index += cnt;
+    if (index >= _capacity) {
+        index -= _capacity;
+    }
+    return index;
+}
+
+#endif
+
+#endif
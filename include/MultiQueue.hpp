@@ -0,0 +1,234 @@
+#ifndef MULTI_QUEUE_HPP
+#define MULTI_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Layout.hpp"
+#include "Platform.hpp"
+
+// Relaxed concurrent priority queue for arbitrary keys (Rihani, Sanders &
+// Dementiev's MultiQueue).
+//
+// The queue is c * threads ordinary sequential binary heaps, each behind its
+// own try-lock. Push inserts into a random heap. Pop samples two random heaps,
+// reads their cached top keys without locking, and pops from the better one.
+// No operation ever waits for a lock: a busy heap is simply resampled.
+//
+// Pops are not strictly ordered. The popped key's rank among all queued keys
+// is expected to be O(c * threads). A larger c means more heaps, so less
+// contention and more throughput, but larger rank errors.
+//
+// Compare(a, b) is true when a should be popped before b, so the default
+// std::less pops the smallest key first, as for deadlines or timestamps. Keys
+// are cached in atomics for the lock-free peek and must be trivially copyable.
+template <typename Key, typename Value, typename Compare = std::less<Key>> class MultiQueue {
+    static_assert(std::is_trivially_copyable<Key>::value, "Key must be trivially copyable");
+
+  public:
+    explicit MultiQueue(size_t threads = std::thread::hardware_concurrency(), size_t c = 2U);
+    MultiQueue(const MultiQueue &) = delete;
+    MultiQueue &operator=(const MultiQueue &) = delete;
+
+    void Push(const Key &key, const Value &value);
+    // Returns false only if every heap looked empty.
+    bool TryPop(Key &key, Value &value);
+    // Pops up to max elements into out, several from each locked heap while it
+    // stays ahead of the other sampled heap. Returns the number popped.
+    size_t PopBatch(std::pair<Key, Value> *out, size_t max);
+
+    size_t QueueCount() const { return _queue_count; }
+
+  private:
+    struct alignas(CACHE_LINE_SIZE) SubQueue {
+        std::atomic<bool> locked{false};
+        std::atomic<bool> empty{true};
+        std::atomic<Key> top{};
+        std::vector<std::pair<Key, Value>> heap;
+
+        bool TryLock() {
+            return !locked.load(std::memory_order_relaxed) &&
+                   !locked.exchange(true, std::memory_order_acquire);
+        }
+        void Unlock() { locked.store(false, std::memory_order_release); }
+    };
+
+    // Heap order for std::push_heap / pop_heap: the element to pop first must
+    // compare greatest.
+    struct HeapOrder {
+        Compare compare;
+        bool operator()(const std::pair<Key, Value> &a, const std::pair<Key, Value> &b) const {
+            return compare(b.first, a.first);
+        }
+    };
+
+    static size_t Random(size_t bound);
+
+    // Pops up to max elements from the better of two sampled heaps. Returns 0
+    // only if every heap looked empty.
+    size_t PopFromBest(std::pair<Key, Value> *out, size_t max);
+    bool AllEmpty() const;
+    void UpdateTop(SubQueue &queue);
+
+    size_t _queue_count;
+    std::unique_ptr<SubQueue[]> _queues;
+    [[no_unique_address]] Compare _compare;
+};
+
+template <typename Key, typename Value, typename Compare>
+MultiQueue<Key, Value, Compare>::MultiQueue(size_t threads, size_t c)
+    : _queue_count(std::max<size_t>(2U, std::max<size_t>(1U, threads) * std::max<size_t>(1U, c))),
+      _queues(new SubQueue[_queue_count]) {}
+
+template <typename Key, typename Value, typename Compare>
+size_t MultiQueue<Key, Value, Compare>::Random(size_t bound) {
+    static thread_local uint64_t state =
+        0x9E3779B97F4A7C15ULL ^ reinterpret_cast<uintptr_t>(&state);
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return static_cast<size_t>(state % bound);
+}
+
+// Must be called with queue locked.
+template <typename Key, typename Value, typename Compare>
+void MultiQueue<Key, Value, Compare>::UpdateTop(SubQueue &queue) {
+    if (queue.heap.empty()) {
+        queue.empty.store(true, std::memory_order_relaxed);
+    } else {
+        queue.top.store(queue.heap.front().first, std::memory_order_relaxed);
+        queue.empty.store(false, std::memory_order_relaxed);
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+void MultiQueue<Key, Value, Compare>::Push(const Key &key, const Value &value) {
+    while (true) {
+        SubQueue &queue = _queues[Random(_queue_count)];
+        if (!queue.TryLock()) {
+            CpuRelax();
+            continue;
+        }
+        try {
+            queue.heap.emplace_back(key, value);
+            std::push_heap(queue.heap.begin(), queue.heap.end(), HeapOrder{_compare});
+        } catch (...) {
+            // bad_alloc or a throwing Value copy: never leave the heap locked.
+            UpdateTop(queue);
+            queue.Unlock();
+            throw;
+        }
+        UpdateTop(queue);
+        queue.Unlock();
+        return;
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+bool MultiQueue<Key, Value, Compare>::AllEmpty() const {
+    for (size_t i = 0; i < _queue_count; ++i) {
+        if (!_queues[i].empty.load(std::memory_order_relaxed) || _queues[i].locked.load(std::memory_order_relaxed)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare>
+size_t MultiQueue<Key, Value, Compare>::PopFromBest(std::pair<Key, Value> *out, size_t max) {
+    size_t misses = 0;
+    while (true) {
+        SubQueue *first = &_queues[Random(_queue_count)];
+        SubQueue *second = &_queues[Random(_queue_count)];
+
+        const bool first_empty = first->empty.load(std::memory_order_relaxed);
+        const bool second_empty = second->empty.load(std::memory_order_relaxed);
+        if (first_empty && second_empty) {
+            // Sampling keeps missing; check once whether there is anything at all.
+            if (++misses >= 4U) {
+                misses = 0;
+                if (AllEmpty()) {
+                    return 0;
+                }
+            }
+            continue;
+        }
+
+        bool has_bound = false;
+        Key bound{};
+        if (first_empty || (!second_empty && _compare(second->top.load(std::memory_order_relaxed),
+                                                      first->top.load(std::memory_order_relaxed)))) {
+            std::swap(first, second);
+        }
+        if (!first->empty.load(std::memory_order_relaxed) && first != second &&
+            !second->empty.load(std::memory_order_relaxed)) {
+            bound = second->top.load(std::memory_order_relaxed);
+            has_bound = true;
+        }
+
+        if (!first->TryLock()) {
+            CpuRelax();
+            continue;
+        }
+
+        size_t popped = 0;
+        HeapOrder order{_compare};
+        try {
+            while (popped < max && !first->heap.empty()) {
+                // After the first element, only keep going while this heap is
+                // still ahead of the other candidate.
+                if (popped > 0 && has_bound && _compare(bound, first->heap.front().first)) {
+                    break;
+                }
+                std::pop_heap(first->heap.begin(), first->heap.end(), order);
+                out[popped++] = std::move(first->heap.back());
+                first->heap.pop_back();
+            }
+        } catch (...) {
+            // A throwing Compare or Value move; as in Push, release the heap.
+            UpdateTop(*first);
+            first->Unlock();
+            throw;
+        }
+        UpdateTop(*first);
+        first->Unlock();
+
+        if (popped > 0) {
+            return popped;
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+bool MultiQueue<Key, Value, Compare>::TryPop(Key &key, Value &value) {
+    std::pair<Key, Value> element;
+    if (PopFromBest(&element, 1U) == 0U) {
+        return false;
+    }
+    key = element.first;
+    value = std::move(element.second);
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare>
+size_t MultiQueue<Key, Value, Compare>::PopBatch(std::pair<Key, Value> *out, size_t max) {
+    size_t count = 0;
+    while (count < max) {
+        const size_t popped = PopFromBest(out + count, max - count);
+        if (popped == 0U) {
+            break;
+        }
+        count += popped;
+    }
+    return count;
+}
+
+#endif
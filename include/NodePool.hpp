@@ -0,0 +1,304 @@
+#ifndef NODE_POOL_HPP
+#define NODE_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "Layout.hpp"
+
+// Fixed-size block pool with per-thread magazines (Bonwick & Adams, 2001).
+//
+// Each thread caches two magazines of up to MAGAZINE_SIZE free blocks, so
+// almost every Allocate/Deallocate is a thread-local array push or pop. Only
+// when both magazines are empty (or both full) does a thread exchange a whole
+// magazine with the global depot. The depot is a pair of lock-free Treiber
+// stacks, one for loaded magazines and one for empty ones. Blocks freed on one
+// thread therefore flow back to the others a magazine at a time. When the
+// depot runs dry, a new slab of MAGAZINE_SIZE contiguous blocks is carved up.
+//
+// Depot links are 32-bit magazine indices packed with a 32-bit version tag
+// into one 64-bit word, so the stacks are ABA-safe without a double-width CAS.
+// Magazines and slabs are never freed; the pool only grows to the peak number
+// of live blocks, and its memory stays reachable for the life of the process.
+template <size_t BlockSize, size_t BlockAlign = alignof(std::max_align_t)>
+class NodePool {
+  public:
+    static constexpr size_t MAGAZINE_SIZE = 64U;
+
+    static void *Allocate();
+    static void Deallocate(void *ptr);
+
+  private:
+    static constexpr size_t BLOCK_SIZE = (BlockSize + BlockAlign - 1U) / BlockAlign * BlockAlign;
+    static constexpr uint32_t CHUNK_SIZE = 256U;
+    static constexpr uint32_t MAX_CHUNKS = 4096U;
+
+    struct Magazine {
+        uint32_t index;
+        std::atomic<uint32_t> next;
+        size_t count;
+        void *blocks[MAGAZINE_SIZE];
+    };
+
+    struct Slab {
+        Slab *next;
+        alignas(BlockAlign) unsigned char storage[BLOCK_SIZE * MAGAZINE_SIZE];
+    };
+
+    // Stack head: (tag << 32) | (index + 1), 0 meaning empty.
+    struct alignas(CACHE_LINE_SIZE) Stack {
+        std::atomic<uint64_t> head{0U};
+    };
+
+    struct Depot {
+        Stack loaded;
+        Stack empty;
+        std::atomic<uint32_t> magazine_count{0U};
+        std::atomic<Magazine *> chunks[MAX_CHUNKS] = {};
+        std::atomic<Slab *> slabs{nullptr};
+    };
+
+    struct ThreadCache {
+        Magazine *loaded = nullptr;
+        Magazine *previous = nullptr;
+
+        ~ThreadCache();
+    };
+
+    static Depot &GetDepot();
+    static ThreadCache *Cache();
+    static bool &CacheDestroyed();
+
+    static Magazine *NewMagazine();
+    static Magazine *MagazineAt(uint32_t index);
+    static void Push(Stack &stack, Magazine *magazine);
+    static Magazine *Pop(Stack &stack);
+    static Magazine *PopEmpty();
+    static void Return(Magazine *magazine);
+    static Magazine *NewSlab();
+};
+
+// Allocator policies for the node-based containers. Both construct and destroy
+// whole objects; PoolAllocator draws the memory from the NodePool matching the
+// object's size and alignment.
+struct NewAllocator {
+    template <typename T, typename... Args> static T *create(Args &&...args) {
+        return new T(std::forward<Args>(args)...);
+    }
+
+    template <typename T> static void destroy(T *ptr) { delete ptr; }
+};
+
+struct PoolAllocator {
+    template <typename T, typename... Args> static T *create(Args &&...args) {
+        void *memory = NodePool<sizeof(T), alignof(T)>::Allocate();
+        return new (memory) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T> static void destroy(T *ptr) {
+        if (ptr != nullptr) {
+            ptr->~T();
+            NodePool<sizeof(T), alignof(T)>::Deallocate(ptr);
+        }
+    }
+};
+
+template <size_t BlockSize, size_t BlockAlign>
+typename NodePool<BlockSize, BlockAlign>::Depot &NodePool<BlockSize, BlockAlign>::GetDepot() {
+    static Depot depot;
+    return depot;
+}
+
+// Returns nullptr once the calling thread's cache has been torn down, which
+// happens when other thread-local destructors (a reclaimer flushing its
+// retired list, say) free nodes during thread exit.
+template <size_t BlockSize, size_t BlockAlign>
+typename NodePool<BlockSize, BlockAlign>::ThreadCache *NodePool<BlockSize, BlockAlign>::Cache() {
+    static thread_local ThreadCache cache;
+    return CacheDestroyed() ? nullptr : &cache;
+}
+
+template <size_t BlockSize, size_t BlockAlign>
+bool &NodePool<BlockSize, BlockAlign>::CacheDestroyed() {
+    static thread_local bool destroyed = false;
+    return destroyed;
+}
+
+template <size_t BlockSize, size_t BlockAlign>
+NodePool<BlockSize, BlockAlign>::ThreadCache::~ThreadCache() {
+    CacheDestroyed() = true;
+    if (loaded != nullptr) {
+        Return(loaded);
+    }
+    if (previous != nullptr) {
+        Return(previous);
+    }
+}
+
+template <size_t BlockSize, size_t BlockAlign>
+typename NodePool<BlockSize, BlockAlign>::Magazine *NodePool<BlockSize, BlockAlign>::MagazineAt(uint32_t index) {
+    return &GetDepot().chunks[index / CHUNK_SIZE].load(std::memory_order_acquire)[index % CHUNK_SIZE];
+}
+
+template <size_t BlockSize, size_t BlockAlign>
+typename NodePool<BlockSize, BlockAlign>::Magazine *NodePool<BlockSize, BlockAlign>::NewMagazine() {
+    Depot &depot = GetDepot();
+    const uint32_t index = depot.magazine_count.fetch_add(1U, std::memory_order_relaxed);
+    if (index >= CHUNK_SIZE * MAX_CHUNKS) {
+        throw std::bad_alloc();
+    }
+
+    std::atomic<Magazine *> &chunk = depot.chunks[index / CHUNK_SIZE];
+    Magazine *magazines = chunk.load(std::memory_order_acquire);
+    if (magazines == nullptr) {
+        Magazine *fresh = new Magazine[CHUNK_SIZE];
+        if (chunk.compare_exchange_strong(magazines, fresh, std::memory_order_acq_rel,
+                                          std::memory_order_acquire)) {
+            magazines = fresh;
+        } else {
+            delete[] fresh;
+        }
+    }
+
+    Magazine *magazine = &magazines[index % CHUNK_SIZE];
+    magazine->index = index;
+    magazine->count = 0U;
+    return magazine;
+}
+
+template <size_t BlockSize, size_t BlockAlign>
+void NodePool<BlockSize, BlockAlign>::Push(Stack &stack, Magazine *magazine) {
+    uint64_t head = stack.head.load(std::memory_order_relaxed);
+    uint64_t desired;
+    do {
+        magazine->next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        desired = ((head >> 32) + 1U) << 32 | (magazine->index + 1U);
+    } while (!stack.head.compare_exchange_weak(head, desired, std::memory_order_release,
+                                               std::memory_order_relaxed));
+}
+
+template <size_t BlockSize, size_t BlockAlign>
+typename NodePool<BlockSize, BlockAlign>::Magazine *NodePool<BlockSize, BlockAlign>::Pop(Stack &stack) {
+    uint64_t head = stack.head.load(std::memory_order_acquire);
+    while (true) {
+        const uint32_t top = static_cast<uint32_t>(head);
+        if (top == 0U) {
+            return nullptr;
+        }
+        Magazine *magazine = MagazineAt(top - 1U);
+        // May read a stale link if the magazine was popped meanwhile; the
+        // tag then makes the CAS fail.
+        const uint32_t next = magazine->next.load(std::memory_order_relaxed);
+        const uint64_t desired = ((head >> 32) + 1U) << 32 | next;
+        if (stack.head.compare_exchange_weak(head, desired, std::memory_order_acquire,
+                                             std::memory_order_acquire)) {
+            return magazine;
+        }
+    }
+}
+
+template <size_t BlockSize, size_t BlockAlign>
+typename NodePool<BlockSize, BlockAlign>::Magazine *NodePool<BlockSize, BlockAlign>::PopEmpty() {
+    Magazine *magazine = Pop(GetDepot().empty);
+    return magazine != nullptr ? magazine : NewMagazine();
+}
+
+template <size_t BlockSize, size_t BlockAlign>
+void NodePool<BlockSize, BlockAlign>::Return(Magazine *magazine) {
+    Push(magazine->count > 0U ? GetDepot().loaded : GetDepot().empty, magazine);
+}
+
+// Carves a new slab into a magazine, lowest address on top.
+template <size_t BlockSize, size_t BlockAlign>
+typename NodePool<BlockSize, BlockAlign>::Magazine *NodePool<BlockSize, BlockAlign>::NewSlab() {
+    Depot &depot = GetDepot();
+    Slab *slab = new Slab;
+    slab->next = depot.slabs.load(std::memory_order_relaxed);
+    while (!depot.slabs.compare_exchange_weak(slab->next, slab, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+    }
+
+    Magazine *magazine = PopEmpty();
+    for (size_t i = 0; i < MAGAZINE_SIZE; ++i) {
+        magazine->blocks[i] = slab->storage + (MAGAZINE_SIZE - 1U - i) * BLOCK_SIZE;
+    }
+    magazine->count = MAGAZINE_SIZE;
+    return magazine;
+}
+
+template <size_t BlockSize, size_t BlockAlign>
+void *NodePool<BlockSize, BlockAlign>::Allocate() {
+    ThreadCache *cache = Cache();
+    if (cache == nullptr) {
+        // Thread is exiting: take one block and hand the rest straight back.
+        Magazine *magazine = Pop(GetDepot().loaded);
+        if (magazine == nullptr) {
+            magazine = NewSlab();
+        }
+        void *ptr = magazine->blocks[--magazine->count];
+        Return(magazine);
+        return ptr;
+    }
+
+    if (cache->loaded == nullptr) {
+        cache->loaded = PopEmpty();
+        cache->previous = PopEmpty();
+    }
+
+    if (cache->loaded->count == 0U) {
+        if (cache->previous->count > 0U) {
+            std::swap(cache->loaded, cache->previous);
+        } else {
+            Magazine *full = Pop(GetDepot().loaded);
+            if (full == nullptr) {
+                full = NewSlab();
+            }
+            Push(GetDepot().empty, cache->previous);
+            cache->previous = cache->loaded;
+            cache->loaded = full;
+        }
+    }
+    return cache->loaded->blocks[--cache->loaded->count];
+}
+
+template <size_t BlockSize, size_t BlockAlign>
+void NodePool<BlockSize, BlockAlign>::Deallocate(void *ptr) {
+    ThreadCache *cache = Cache();
+    if (cache == nullptr) {
+        // Thread is exiting, typically with a reclaimer flushing its retired
+        // nodes one by one: top up the magazine on top of the depot instead
+        // of parking every block in a magazine of its own.
+        Magazine *magazine = Pop(GetDepot().loaded);
+        if (magazine != nullptr && magazine->count == MAGAZINE_SIZE) {
+            Push(GetDepot().loaded, magazine);
+            magazine = nullptr;
+        }
+        if (magazine == nullptr) {
+            magazine = PopEmpty();
+        }
+        magazine->blocks[magazine->count++] = ptr;
+        Return(magazine);
+        return;
+    }
+
+    if (cache->loaded == nullptr) {
+        cache->loaded = PopEmpty();
+        cache->previous = PopEmpty();
+    }
+
+    if (cache->loaded->count == MAGAZINE_SIZE) {
+        if (cache->previous->count < MAGAZINE_SIZE) {
+            std::swap(cache->loaded, cache->previous);
+        } else {
+            Push(GetDepot().loaded, cache->previous);
+            cache->previous = cache->loaded;
+            cache->loaded = PopEmpty();
+        }
+    }
+    cache->loaded->blocks[cache->loaded->count++] = ptr;
+}
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// NUMA topology and node-local memory, read straight from Linux sysfs and the
+// mbind system call so there is no libnuma dependency.
+//
+// Nodes are numbered densely from 0 here; NodeId maps back to the kernel's
+// (possibly sparse) node number. Where sysfs is missing, as on other systems
+// or in some containers, the machine is reported as one node holding every
+// CPU, and NumaAllocate falls back to ordinary page-aligned memory.
+
+// Parses a sysfs list such as "0-3,8,10-11" into its members.
+inline std::vector<size_t> ParseCpuList(const std::string &text) {
+    std::vector<size_t> members;
+    size_t pos = 0U;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        const std::string range = text.substr(pos, end - pos);
+        const size_t dash = range.find('-');
+        try {
+            const size_t first = std::stoul(range.substr(0U, dash));
+            const size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1U));
+            for (size_t i = first; i <= last; ++i) {
+                members.push_back(i);
+            }
+        } catch (const std::exception &) {
+            // Blank or malformed entry (the trailing newline, say): skip it.
+        }
+        pos = end + 1U;
+    }
+    return members;
+}
+
+class NumaTopology {
+  public:
+    // Read once, on first use.
+    static const NumaTopology &Get() {
+        static const NumaTopology topology;
+        return topology;
+    }
+
+    size_t NodeCount() const { return _node_ids.size(); }
+    size_t NodeId(size_t node) const { return _node_ids[node]; }
+    const std::vector<size_t> &Cpus(size_t node) const { return _cpus[node]; }
+
+    // Node of cpu, or 0 for a CPU sysfs did not list.
+    size_t NodeOfCpu(size_t cpu) const { return cpu < _cpu_node.size() ? _cpu_node[cpu] : 0U; }
+
+  private:
+    NumaTopology();
+
+    std::vector<size_t> _node_ids;
+    std::vector<std::vector<size_t>> _cpus;
+    std::vector<size_t> _cpu_node;
+};
+
+inline NumaTopology::NumaTopology() {
+    const std::string root = "/sys/devices/system/node/";
+    std::string line;
+    std::ifstream online(root + "online");
+    if (online && std::getline(online, line)) {
+        for (size_t id : ParseCpuList(line)) {
+            std::ifstream cpulist(root + "node" + std::to_string(id) + "/cpulist");
+            std::string cpus;
+            std::getline(cpulist, cpus);
+            // Memory-only nodes have no CPUs to run producers or consumers.
+            std::vector<size_t> members = ParseCpuList(cpus);
+            if (!members.empty()) {
+                _node_ids.push_back(id);
+                _cpus.push_back(std::move(members));
+            }
+        }
+    }
+
+    if (_node_ids.empty()) {
+        const size_t cores = std::thread::hardware_concurrency();
+        _node_ids.push_back(0U);
+        _cpus.emplace_back();
+        for (size_t cpu = 0; cpu < (cores == 0U ? 1U : cores); ++cpu) {
+            _cpus.back().push_back(cpu);
+        }
+    }
+
+    for (size_t node = 0; node < _cpus.size(); ++node) {
+        for (size_t cpu : _cpus[node]) {
+            if (cpu >= _cpu_node.size()) {
+                _cpu_node.resize(cpu + 1U, 0U);
+            }
+            _cpu_node[cpu] = node;
+        }
+    }
+}
+
+// Node the calling thread is running on right now. An unpinned thread may
+// have moved by the time the caller acts on the answer.
+inline size_t CurrentNumaNode() {
+#if defined(__linux__)
+    const int cpu = sched_getcpu();
+    return cpu < 0 ? 0U : NumaTopology::Get().NodeOfCpu(static_cast<size_t>(cpu));
+#else
+    return 0U;
+#endif
+}
+
+// Allocates bytes of page-aligned memory whose pages prefer node. The
+// preference is best effort: it silently does nothing on a kernel without
+// NUMA support. Release with NumaFree and the same size.
+inline void *NumaAllocate(size_t bytes, size_t node) {
+#if defined(__linux__)
+    void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    // MPOL_PREFERRED rather than MPOL_BIND, so a full node spills over
+    // instead of failing the page fault. Pages are placed on first touch,
+    // which is after this call.
+    constexpr int MPOL_PREFERRED_MODE = 1;
+    constexpr size_t MASK_BITS = 1024U;
+    unsigned long mask[MASK_BITS / (8U * sizeof(unsigned long))] = {};
+    const size_t id = NumaTopology::Get().NodeId(node);
+    if (id < MASK_BITS) {
+        mask[id / (8U * sizeof(unsigned long))] |= 1UL << (id % (8U * sizeof(unsigned long)));
+        // The kernel reads one bit fewer than maxnode.
+        syscall(SYS_mbind, memory, bytes, MPOL_PREFERRED_MODE, mask, MASK_BITS + 1U, 0U);
+    }
+    return memory;
+#else
+    (void)node;
+    return ::operator new(bytes, std::align_val_t(4096));
+#endif
+}
+
+inline void NumaFree(void *memory, size_t bytes) {
+#if defined(__linux__)
+    munmap(memory, bytes);
+#else
+    (void)bytes;
+    ::operator delete(memory, std::align_val_t(4096));
+#endif
+}
+
+#endif
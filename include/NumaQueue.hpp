@@ -0,0 +1,124 @@
+#ifndef NUMA_QUEUE_HPP
+#define NUMA_QUEUE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#include "Numa.hpp"
+#include "Queue.hpp"
+
+// MPMC queue sharded by NUMA node.
+//
+// A single Queue keeps its indices and every slot on one node, so producers
+// and consumers on the other sockets pay a remote access on each operation.
+// NumaQueue holds one Queue per node instead, each allocated in memory
+// preferring its node. Push goes to the calling thread's node. Pop drains the
+// local shard first and only then steals from the other shards, visiting them
+// in turn starting after its own node.
+//
+// Order is FIFO within a shard only; elements pushed on different nodes may
+// be popped in any order. Push returns false when the local shard is full,
+// even if a remote one has room, so that producers never write remote slots.
+// On a single-node machine there is one shard, the node lookup is skipped and
+// NumaQueue behaves like a plain Queue.
+//
+// The calling thread's node is looked up with sched_getcpu and cached for
+// NODE_REFRESH operations, so an unpinned thread that migrates may keep using
+// its old shard for a while. Pin threads for the full benefit.
+template <typename T, size_t size, typename Layout = CompactLayout> class NumaQueue {
+  public:
+    NumaQueue();
+    ~NumaQueue();
+    NumaQueue(const NumaQueue &) = delete;
+    NumaQueue &operator=(const NumaQueue &) = delete;
+
+    bool Push(const T &element) { return Push(element, _shard_count == 1U ? 0U : LocalNode()); }
+    bool Pop(T &element) { return Pop(element, _shard_count == 1U ? 0U : LocalNode()); }
+
+    // As above, for callers that track their own placement. node is a dense
+    // index as used by NumaTopology.
+    bool Push(const T &element, size_t node);
+    bool Pop(T &element, size_t node);
+
+    size_t ShardCount() const { return _shard_count; }
+
+  private:
+    using Shard = Queue<T, size, Layout>;
+
+    static constexpr size_t NODE_REFRESH = 64U;
+
+    size_t LocalNode() const;
+    // Destroys and frees the first count shards.
+    void FreeShards(size_t count);
+
+    size_t _shard_count;
+    std::unique_ptr<Shard *[]> _shards;
+};
+
+template <typename T, size_t size, typename Layout>
+NumaQueue<T, size, Layout>::NumaQueue()
+    : _shard_count(NumaTopology::Get().NodeCount()), _shards(new Shard *[_shard_count]) {
+    size_t built = 0U;
+    try {
+        for (; built < _shard_count; ++built) {
+            void *memory = NumaAllocate(sizeof(Shard), built);
+            try {
+                // Constructing the shard touches its pages, placing them on
+                // node.
+                _shards[built] = new (memory) Shard();
+            } catch (...) {
+                NumaFree(memory, sizeof(Shard));
+                throw;
+            }
+        }
+    } catch (...) {
+        // The destructor will not run; undo the shards already built.
+        FreeShards(built);
+        throw;
+    }
+}
+
+template <typename T, size_t size, typename Layout> NumaQueue<T, size, Layout>::~NumaQueue() {
+    FreeShards(_shard_count);
+}
+
+template <typename T, size_t size, typename Layout> void NumaQueue<T, size, Layout>::FreeShards(size_t count) {
+    for (size_t node = 0; node < count; ++node) {
+        _shards[node]->~Shard();
+        NumaFree(_shards[node], sizeof(Shard));
+    }
+}
+
+template <typename T, size_t size, typename Layout> size_t NumaQueue<T, size, Layout>::LocalNode() const {
+    struct Cache {
+        size_t node = 0U;
+        size_t remaining = 0U;
+    };
+    static thread_local Cache cache;
+    if (cache.remaining == 0U) {
+        cache.node = CurrentNumaNode();
+        cache.remaining = NODE_REFRESH;
+    }
+    --cache.remaining;
+    return cache.node;
+}
+
+template <typename T, size_t size, typename Layout>
+bool NumaQueue<T, size, Layout>::Push(const T &element, size_t node) {
+    return _shards[node % _shard_count]->Push(element);
+}
+
+template <typename T, size_t size, typename Layout>
+bool NumaQueue<T, size, Layout>::Pop(T &element, size_t node) {
+    const size_t local = node % _shard_count;
+    for (size_t i = 0; i < _shard_count; ++i) {
+        const size_t shard = local + i < _shard_count ? local + i : local + i - _shard_count;
+        if (_shards[shard]->Pop(element)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif
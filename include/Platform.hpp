@@ -0,0 +1,57 @@
+#ifndef PLATFORM_HPP
+#define PLATFORM_HPP
+
+#include <cstddef>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LFDS_X86 1
+#endif
+
+// Tells the CPU we are in a spin-wait loop. Lowers power use and avoids the
+// memory-order mis-speculation penalty when the awaited line finally changes.
+inline void CpuRelax() {
+#if defined(LFDS_X86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Hints that ptr will be read soon. No-op where no intrinsic is available.
+inline void Prefetch(const void* ptr) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(ptr, 0, 3);
+#elif defined(LFDS_X86)
+    _mm_prefetch(static_cast<const char*>(ptr), _MM_HINT_T0);
+#else
+    (void)ptr;
+#endif
+}
+
+// Restricts the calling thread to one CPU. Returns false where pinning is
+// unsupported or the CPU is not available to this process.
+inline bool PinCurrentThread(size_t cpu) {
+#if defined(__linux__)
+    if (cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+#endif
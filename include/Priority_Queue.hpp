@@ -1,47 +1,331 @@
 #ifndef PRIORITY_QUEUE_HPP
 #define PRIORITY_QUEUE_HPP
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
 #include <cassert>
 #include <type_traits>
 #include <optional>
+#include <utility>
+#include "Backoff.hpp"
+#include "Layout.hpp"
 #include "Queue.hpp"
 
 
-template <typename T, size_t size, size_t priority_count> class PriorityQueue {
-    static_assert(std::is_trivial<T>::value, "The type T must be trivial");
+// Scheduling policies for PriorityQueue::Pop.
+//
+// StrictPriority always pops from the highest non-empty level, so a saturated
+// high level starves everything below it. WeightedFair serves the levels in
+// deficit round robin: each consumer visits the non-empty levels from the top
+// down and pops up to the level's share before moving on, so every level gets
+// a fixed fraction of the pops while it has work. The top bypass_levels levels
+// are exempt and still pre-empt the round, strictly by priority.
+struct StrictPriority {
+    static constexpr bool weighted = false;
+    static constexpr size_t bypass_levels = 0U;
+};
+
+template <size_t BypassLevels = 0U> struct WeightedFair {
+    static constexpr bool weighted = true;
+    static constexpr size_t bypass_levels = BypassLevels;
+};
+
+// Pop finds the highest non-empty level through a two-level occupancy bitmap
+// instead of probing every level: one bit per level in _level_bits, and one
+// bit per non-zero _level_bits word in _word_bits. Both are read with
+// count-leading-zeros, so Pop probes a single sub-queue in the common case.
+//
+// Push sets the bits after its element is in place; Pop clears a level's bit
+// when a probe comes back empty and then probes that level once more, so an
+// element pushed concurrently is never stranded behind a cleared bit. A bit
+// may be stale (set for an empty level), which costs Pop one extra probe.
+//
+// Under WeightedFair the round-robin position and remaining share live in a
+// thread-local per consumer, and the shares are only read on Pop, so the
+// policy adds no shared writes to the pop path. A consumer alternating between
+// two queues of the same type restarts its round on each switch.
+//
+// Backoff is handed to the sub-queues and paces their retries; see
+// Backoff.hpp.
+//
+// T may be any type the sub-queues accept; see Queue.hpp. For a non-trivial T
+// a level is drained one element at a time instead of with a bulk dequeue,
+// and PopBatch and Pop move-assign into the caller's elements.
+template <typename T, size_t size, size_t priority_count, typename Schedule = StrictPriority,
+          typename Backoff = NoBackoff>
+class PriorityQueue {
     static_assert(size > 2, "Buffer size must be bigger than 2");
+    static_assert(priority_count > 0 && priority_count <= 4096,
+                  "priority_count must be between 1 and 4096");
+    static_assert(Schedule::bypass_levels < priority_count,
+                  "At least one level must be scheduled by weight");
 
-    
   public:
-    
-    bool Push(const T &element, size_t priority);
+    bool Push(const T &element, size_t priority) { return Emplace(priority, element); }
+    bool Push(T &&element, size_t priority) { return Emplace(priority, std::move(element)); }
+    // Constructs the element in place at priority; see Queue::Emplace.
+    template <typename... Args>
+    bool Emplace(size_t priority, Args &&...args);
     bool Pop(T &element);
+    // Needs a default constructible T.
     std::optional<T> PopOptional();
+    // Pops up to max elements into out in one downward pass over the levels
+    // (or one stretch of the round under WeightedFair), taking each level's
+    // elements with a single bulk dequeue. Elements pushed above the current
+    // level during the pass wait for the next call. Returns the number popped.
+    size_t PopBatch(T *out, size_t max);
+
+    // Pops per round-robin turn for a level under WeightedFair. Defaults to
+    // priority + 1, so higher levels get proportionally more of the pops.
+    void SetShare(size_t priority, uint32_t share);
+    uint32_t Share(size_t priority) const;
 
   private:
-    Queue<T, size> _subqueue[priority_count];
+    static constexpr size_t BITS_PER_WORD = 64U;
+    static constexpr size_t LEVEL_WORDS = (priority_count + BITS_PER_WORD - 1U) / BITS_PER_WORD;
+    static constexpr size_t NO_LEVEL = priority_count;
+    static constexpr size_t TOP_WEIGHTED = priority_count - 1U - Schedule::bypass_levels;
+
+    struct RoundState {
+        const void *owner = nullptr;
+        size_t level = 0U;
+        uint32_t remaining = 0U;
+    };
+
+    struct NoShares {};
+    using Shares = std::conditional_t<Schedule::weighted, std::atomic<uint32_t>[priority_count], NoShares>;
+
+    void MarkNonEmpty(size_t priority);
+    size_t FindLevel(size_t highest);
+    size_t PopLevel(size_t priority, T *out, size_t max);
+    size_t DrainLevel(size_t priority, T *out, size_t max);
+    // Strict descent over the levels at or above lowest.
+    size_t PopStrict(T *out, size_t max, size_t lowest);
+    size_t PopWeighted(T *out, size_t max);
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> _word_bits{0U};
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> _level_bits[LEVEL_WORDS] = {};
+    // Zero means the default share.
+    [[no_unique_address]] Shares _share = {};
+    Queue<T, size, CompactLayout, NoStats, Backoff> _subqueue[priority_count];
 };
 
-template <typename T, size_t size, size_t priority_count>
-bool PriorityQueue<T, size, priority_count>::Push(const T &element,
-                                                  const size_t priority) {
+// Must be called after the element is visible in the sub-queue. The fence
+// pairs with the one in PopLevel: either its second probe sees the element,
+// or this sees the cleared bit and sets it again.
+template <typename T, size_t size, size_t priority_count, typename Schedule, typename Backoff>
+void PriorityQueue<T, size, priority_count, Schedule, Backoff>::MarkNonEmpty(size_t priority) {
+    const size_t word = priority / BITS_PER_WORD;
+    const uint64_t level_bit = uint64_t(1) << (priority % BITS_PER_WORD);
+    const uint64_t word_bit = uint64_t(1) << word;
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // Plain loads first so hot levels do not bounce the line with RMWs.
+    if ((_level_bits[word].load() & level_bit) == 0U) {
+        _level_bits[word].fetch_or(level_bit);
+    }
+    if ((_word_bits.load() & word_bit) == 0U) {
+        _word_bits.fetch_or(word_bit);
+    }
+}
+
+// Returns the highest level at or below highest whose bit is set, or
+// NO_LEVEL.
+template <typename T, size_t size, size_t priority_count, typename Schedule, typename Backoff>
+size_t PriorityQueue<T, size, priority_count, Schedule, Backoff>::FindLevel(size_t highest) {
+    const size_t top_word = highest / BITS_PER_WORD;
+    const size_t top_bit = highest % BITS_PER_WORD;
+    const uint64_t top_mask = top_bit == BITS_PER_WORD - 1U ? ~uint64_t(0)
+                                                            : (uint64_t(1) << (top_bit + 1U)) - 1U;
+
+    const uint64_t top_levels = _level_bits[top_word].load() & top_mask;
+    if (top_levels != 0U) {
+        return top_word * BITS_PER_WORD + BITS_PER_WORD - 1U - std::countl_zero(top_levels);
+    }
+
+    const uint64_t below_mask = (uint64_t(1) << top_word) - 1U;
+    while (true) {
+        const uint64_t words = _word_bits.load() & below_mask;
+        if (words == 0U) {
+            return NO_LEVEL;
+        }
+        const size_t word = BITS_PER_WORD - 1U - std::countl_zero(words);
+        const uint64_t word_bit = uint64_t(1) << word;
+
+        const uint64_t levels = _level_bits[word].load();
+        if (levels != 0U) {
+            return word * BITS_PER_WORD + BITS_PER_WORD - 1U - std::countl_zero(levels);
+        }
+        // Stale summary bit: clear it, then undo if a level was marked in the
+        // meantime.
+        _word_bits.fetch_and(~word_bit);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_level_bits[word].load() != 0U) {
+            _word_bits.fetch_or(word_bit);
+        }
+    }
+}
+
+// Takes up to max elements from one sub-queue: a single bulk dequeue for a
+// trivial T, otherwise one Pop per element.
+template <typename T, size_t size, size_t priority_count, typename Schedule, typename Backoff>
+size_t PriorityQueue<T, size, priority_count, Schedule, Backoff>::DrainLevel(size_t priority, T *out, size_t max) {
+    if constexpr (std::is_trivial<T>::value) {
+        return _subqueue[priority].PopBulk(out, max);
+    } else {
+        size_t count = 0U;
+        while (count < max && _subqueue[priority].Pop(out[count])) {
+            ++count;
+        }
+        return count;
+    }
+}
+
+// Returns 0 only after clearing the level's bit and finding it empty again.
+template <typename T, size_t size, size_t priority_count, typename Schedule, typename Backoff>
+size_t PriorityQueue<T, size, priority_count, Schedule, Backoff>::PopLevel(size_t priority, T *out, size_t max) {
+    const size_t popped = DrainLevel(priority, out, max);
+    if (popped > 0U) {
+        return popped;
+    }
+
+    const size_t word = priority / BITS_PER_WORD;
+    _level_bits[word].fetch_and(~(uint64_t(1) << (priority % BITS_PER_WORD)));
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const size_t raced = DrainLevel(priority, out, max);
+    if (raced > 0U) {
+        // A push raced with the clear; the level may hold more.
+        MarkNonEmpty(priority);
+    }
+    return raced;
+}
+
+template <typename T, size_t size, size_t priority_count, typename Schedule, typename Backoff>
+template <typename... Args>
+bool PriorityQueue<T, size, priority_count, Schedule, Backoff>::Emplace(const size_t priority, Args &&...args) {
     assert(priority < priority_count);
 
-    return _subqueue[priority].Push(element);
+    if (!_subqueue[priority].Emplace(std::forward<Args>(args)...)) {
+        return false;
+    }
+    MarkNonEmpty(priority);
+    return true;
+}
+
+template <typename T, size_t size, size_t priority_count, typename Schedule, typename Backoff>
+bool PriorityQueue<T, size, priority_count, Schedule, Backoff>::Pop(T &element) {
+    return PopBatch(&element, 1U) == 1U;
 }
 
-template <typename T, size_t size, size_t priority_count>
-bool PriorityQueue<T, size, priority_count>::Pop(T &element) {
+template <typename T, size_t size, size_t priority_count, typename Schedule, typename Backoff>
+std::optional<T> PriorityQueue<T, size, priority_count, Schedule, Backoff>::PopOptional() {
+    T element;
+    if (Pop(element)) {
+        return element;
+    }
+    return std::nullopt;
+}
 
-    for (size_t priority = priority_count; priority-- > 0;) {
-        if (_subqueue[priority].Pop(element)) {
-            return true;
+template <typename T, size_t size, size_t priority_count, typename Schedule, typename Backoff>
+size_t PriorityQueue<T, size, priority_count, Schedule, Backoff>::PopBatch(T *out, size_t max) {
+    if (max == 0U) {
+        return 0U;
+    }
+    if constexpr (Schedule::weighted) {
+        return PopWeighted(out, max);
+    } else {
+        return PopStrict(out, max, 0U);
+    }
+}
+
+template <typename T, size_t size, size_t priority_count, typename Schedule, typename Backoff>
+size_t PriorityQueue<T, size, priority_count, Schedule, Backoff>::PopStrict(T *out, size_t max, size_t lowest) {
+    size_t count = 0U;
+    size_t highest = priority_count - 1U;
+    while (count < max) {
+        const size_t priority = FindLevel(highest);
+        if (priority == NO_LEVEL || priority < lowest) {
+            break;
+        }
+        const size_t wanted = max - count;
+        const size_t popped = PopLevel(priority, out + count, wanted);
+        count += popped;
+        if (popped == 0U) {
+            // Bit was stale and is now clear; look again from here.
+            highest = priority;
+        } else if (popped < wanted) {
+            // Level ran dry; carry on below it.
+            if (priority == lowest) {
+                break;
+            }
+            highest = priority - 1U;
         }
     }
+    return count;
+}
 
-    return false;
+template <typename T, size_t size, size_t priority_count, typename Schedule, typename Backoff>
+size_t PriorityQueue<T, size, priority_count, Schedule, Backoff>::PopWeighted(T *out, size_t max) {
+    size_t count = 0U;
+    if constexpr (Schedule::bypass_levels > 0U) {
+        count = PopStrict(out, max, TOP_WEIGHTED + 1U);
+        if (count == max) {
+            return count;
+        }
+    }
+
+    static thread_local RoundState round;
+    if (round.owner != this) {
+        // Start just above the top weighted level, so the first turn-over
+        // lands on it rather than below it.
+        round = RoundState{this, TOP_WEIGHTED + 1U, 0U};
+    }
+
+    while (count < max) {
+        if (round.remaining == 0U) {
+            // Turn over: move to the next non-empty level down, wrapping
+            // around to the top of the round.
+            size_t next = round.level > 0U ? FindLevel(round.level - 1U) : NO_LEVEL;
+            if (next == NO_LEVEL) {
+                next = FindLevel(TOP_WEIGHTED);
+                if (next == NO_LEVEL) {
+                    break;
+                }
+            }
+            round.level = next;
+            round.remaining = Share(next);
+        }
+
+        const size_t wanted = std::min<size_t>(max - count, round.remaining);
+        const size_t popped = PopLevel(round.level, out + count, wanted);
+        count += popped;
+        round.remaining -= static_cast<uint32_t>(popped);
+        if (popped < wanted) {
+            // Level drained: an unused share is not carried over.
+            round.remaining = 0U;
+        }
+    }
+    return count;
+}
+
+template <typename T, size_t size, size_t priority_count, typename Schedule, typename Backoff>
+void PriorityQueue<T, size, priority_count, Schedule, Backoff>::SetShare(size_t priority, uint32_t share) {
+    static_assert(Schedule::weighted, "Shares only apply to a weighted schedule");
+    assert(priority < priority_count);
+    _share[priority].store(share > 0U ? share : 1U, std::memory_order_relaxed);
+}
+
+template <typename T, size_t size, size_t priority_count, typename Schedule, typename Backoff>
+uint32_t PriorityQueue<T, size, priority_count, Schedule, Backoff>::Share(size_t priority) const {
+    if constexpr (Schedule::weighted) {
+        const uint32_t share = _share[priority].load(std::memory_order_relaxed);
+        return share > 0U ? share : static_cast<uint32_t>(priority + 1U);
+    } else {
+        return 1U;
+    }
 }
 
-#endif
\ No newline at end of file
+#endif
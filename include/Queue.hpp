@@ -3,43 +3,176 @@
 
 #include <atomic>
 #include <cstddef>
+#include <new>
 #include <type_traits>
+#include <utility>
 
 #include <optional>
 
-template <typename T, size_t size>
+#include "Backoff.hpp"
+#include "ContentionStats.hpp"
+#include "Layout.hpp"
+
+// T may be any type whose move constructor and destructor do not throw:
+// strings, vectors and unique_ptr pass straight through without boxing.
+// Trivial types are stored as before. Other types live in raw slot storage,
+// constructed in place by Push or Emplace and destroyed by the Pop that
+// moves them out; elements still queued are destroyed with the queue.
+// PushBulk and PopBulk copy whole runs and need a trivial T.
+//
+// StatsPolicy counts contention in Push, Pop and the bulk operations; see
+// ContentionStats.hpp. Backoff paces their retries; see Backoff.hpp. With the
+// defaults, NoStats and NoBackoff, neither costs anything.
+template <typename T, size_t size, typename Layout = CompactLayout,
+          typename StatsPolicy = NoStats, typename Backoff = NoBackoff>
 class Queue
 {
-    static_assert(std::is_trivial<T>::value, "The type T must be trivial");
+    static_assert(std::is_trivial<T>::value || (std::is_nothrow_move_constructible<T>::value &&
+                                                 std::is_nothrow_destructible<T>::value),
+                  "The type T must be trivial, or nothrow move constructible and destructible");
     static_assert(size > 2, "Buffer size must be bigger than 2");
 
+    static constexpr bool TRIVIAL = std::is_trivial<T>::value;
+
 public:
     Queue();
-    bool Push(const T &element);
+    // Trivial elements need no cleanup, which keeps the queue trivially
+    // destructible.
+    ~Queue() requires TRIVIAL = default;
+    ~Queue() requires(!TRIVIAL);
+    bool Push(const T &element) { return Emplace(element); }
+    bool Push(T &&element) { return Emplace(std::move(element)); }
+    // Constructs the element in its slot from args. If that constructor may
+    // throw, the element is built before a slot is claimed and moved in, so
+    // rvalue arguments are consumed even when the queue turns out full.
+    template <typename... Args>
+    bool Emplace(Args &&...args);
+    // Moves the front element into element, which for a non-trivial T needs
+    // a nothrow move assignment.
     bool Pop(T &element);
+    // Moves the front element out, or returns nullopt if the queue is empty.
+    std::optional<T> PopOptional();
+    size_t PushBulk(const T *elements, size_t n);
+    size_t PopBulk(T *elements, size_t max_n);
+
+    // Sums the per-thread counters; all zero unless StatsPolicy is enabled.
+    StatsSnapshot Stats() const { return _stats.Snapshot(); }
 
 private:
-    struct Slot
+    struct alignas(T) RawValue
+    {
+        unsigned char bytes[sizeof(T)];
+    };
+    using Value = std::conditional_t<TRIVIAL, T, RawValue>;
+
+    struct alignas(Layout::slot_align) alignas(std::atomic_size_t) alignas(T) Slot
     {
-        T val;
+        Value val;
         std::atomic_size_t pop_count;
         std::atomic_size_t push_count;
 
         Slot() : pop_count(0U), push_count(0U) {}
     };
 
+    template <typename... Args>
+    static void Construct(Slot &slot, Args &&...args)
+    {
+        if constexpr (TRIVIAL)
+        {
+            slot.val = T(std::forward<Args>(args)...);
+        }
+        else
+        {
+            ::new (static_cast<void *>(slot.val.bytes)) T(std::forward<Args>(args)...);
+        }
+    }
+
+    static T &Element(Slot &slot)
+    {
+        if constexpr (TRIVIAL)
+        {
+            return slot.val;
+        }
+        else
+        {
+            return *std::launder(reinterpret_cast<T *>(slot.val.bytes));
+        }
+    }
+
+    // Moves the slot's element into out and, for a non-trivial T, ends its
+    // lifetime.
+    static void MoveOut(Slot &slot, T &out)
+    {
+        out = std::move(Element(slot));
+        if constexpr (!TRIVIAL)
+        {
+            Element(slot).~T();
+        }
+    }
+
+    static void MoveOut(Slot &slot, std::optional<T> &out)
+    {
+        out.emplace(std::move(Element(slot)));
+        if constexpr (!TRIVIAL)
+        {
+            Element(slot).~T();
+        }
+    }
+
+    // The claim loops behind Emplace and Pop. Once a slot is claimed, args
+    // are constructed into it or its element is moved into out; neither may
+    // throw, since the slot has to be released either way.
+    template <typename... Args>
+    bool PushWith(Args &&...args);
+    template <typename Out>
+    bool PopInto(Out &out);
+
 private:
     Slot _data[size];
-    std::atomic_size_t _r_count;
-    std::atomic_size_t _w_count;
+    alignas(Layout::index_align) std::atomic_size_t _r_count;
+    alignas(Layout::index_align) std::atomic_size_t _w_count;
+    [[no_unique_address]] StatsPolicy _stats;
 };
 
-template <typename T, size_t size>
-Queue<T, size>::Queue() : _r_count(0U), _w_count(0U) {}
+template <typename T, size_t size, typename Layout, typename StatsPolicy, typename Backoff>
+Queue<T, size, Layout, StatsPolicy, Backoff>::Queue() : _r_count(0U), _w_count(0U) {}
+
+// Runs after every producer and consumer is done, so a slot holds an element
+// exactly when its push and pop counts differ.
+template <typename T, size_t size, typename Layout, typename StatsPolicy, typename Backoff>
+Queue<T, size, Layout, StatsPolicy, Backoff>::~Queue() requires(!TRIVIAL)
+{
+    for (Slot &slot : _data)
+    {
+        if (slot.push_count.load(std::memory_order_relaxed) !=
+            slot.pop_count.load(std::memory_order_relaxed))
+        {
+            Element(slot).~T();
+        }
+    }
+}
+
+template <typename T, size_t size, typename Layout, typename StatsPolicy, typename Backoff>
+template <typename... Args>
+bool Queue<T, size, Layout, StatsPolicy, Backoff>::Emplace(Args &&...args)
+{
+    if constexpr (std::is_nothrow_constructible<T, Args &&...>::value)
+    {
+        return PushWith(std::forward<Args>(args)...);
+    }
+    else
+    {
+        T element(std::forward<Args>(args)...);
+        return PushWith(std::move(element));
+    }
+}
 
-template <typename T, size_t size>
-bool Queue<T, size>::Push(const T &element)
+template <typename T, size_t size, typename Layout, typename StatsPolicy, typename Backoff>
+template <typename... Args>
+bool Queue<T, size, Layout, StatsPolicy, Backoff>::PushWith(Args &&...args)
 {
+    _stats.Add(Stat::OPERATIONS);
+    Backoff backoff;
     size_t w_count = _w_count.load(std::memory_order_relaxed);
 
     while (true)
@@ -49,10 +182,11 @@ bool Queue<T, size>::Push(const T &element)
         const size_t push_count =
             _data[index].push_count.load(std::memory_order_acquire);
         const size_t pop_count =
-            _data[index].pop_count.load(std::memory_order_relaxed);
+            _data[index].pop_count.load(std::memory_order_acquire);
 
         if (push_count > pop_count)
         {
+            _stats.Add(Stat::FULL_REJECTIONS);
             return false;
         }
 
@@ -65,22 +199,51 @@ bool Queue<T, size>::Push(const T &element)
             if (_w_count.compare_exchange_weak(w_count, w_count + 1U,
                                                std::memory_order_relaxed))
             {
-                _data[index].val = element;
+                Construct(_data[index], std::forward<Args>(args)...);
                 _data[index].push_count.store(push_count + 1U,
                                               std::memory_order_release);
                 return true;
             }
+            _stats.Add(Stat::CAS_FAILURES);
+            backoff.Pause();
         }
         else
         {
+            _stats.Add(Stat::TURN_WAITS);
+            if (push_count < revolution_count)
+            {
+                // Earlier revolutions still have to push to and pop from
+                // this slot.
+                backoff.Wait(2U * (revolution_count - push_count));
+            }
             w_count = _w_count.load(std::memory_order_relaxed);
         }
+        _stats.Add(Stat::RETRIES);
     }
 }
 
-template <typename T, size_t size>
-bool Queue<T, size>::Pop(T &element)
+template <typename T, size_t size, typename Layout, typename StatsPolicy, typename Backoff>
+bool Queue<T, size, Layout, StatsPolicy, Backoff>::Pop(T &element)
+{
+    static_assert(TRIVIAL || std::is_nothrow_move_assignable<T>::value,
+                  "Pop(T &) needs a nothrow move assignment; use PopOptional");
+    return PopInto(element);
+}
+
+template <typename T, size_t size, typename Layout, typename StatsPolicy, typename Backoff>
+std::optional<T> Queue<T, size, Layout, StatsPolicy, Backoff>::PopOptional()
+{
+    std::optional<T> element;
+    PopInto(element);
+    return element;
+}
+
+template <typename T, size_t size, typename Layout, typename StatsPolicy, typename Backoff>
+template <typename Out>
+bool Queue<T, size, Layout, StatsPolicy, Backoff>::PopInto(Out &out)
 {
+    _stats.Add(Stat::OPERATIONS);
+    Backoff backoff;
     size_t r_count = _r_count.load(std::memory_order_relaxed);
 
     while (true)
@@ -90,11 +253,21 @@ bool Queue<T, size>::Pop(T &element)
         const size_t pop_count =
             _data[index].pop_count.load(std::memory_order_acquire);
         const size_t push_count =
-            _data[index].push_count.load(std::memory_order_relaxed);
+            _data[index].push_count.load(std::memory_order_acquire);
 
         if (pop_count == push_count)
         {
-            return false;
+            // Only report empty for the current read index; a stale one can
+            // point at a slot that has already been drained.
+            const size_t current = _r_count.load(std::memory_order_relaxed);
+            if (current == r_count)
+            {
+                _stats.Add(Stat::EMPTY_REJECTIONS);
+                return false;
+            }
+            r_count = current;
+            _stats.Add(Stat::RETRIES);
+            continue;
         }
 
         const size_t revolution_count = r_count / size;
@@ -106,16 +279,186 @@ bool Queue<T, size>::Pop(T &element)
             if (_r_count.compare_exchange_weak(r_count, r_count + 1U,
                                                std::memory_order_relaxed))
             {
-                element = _data[index].val;
+                MoveOut(_data[index], out);
                 _data[index].pop_count.store(pop_count + 1U,
                                              std::memory_order_release);
                 return true;
             }
+            _stats.Add(Stat::CAS_FAILURES);
+            backoff.Pause();
         }
         else
         {
+            _stats.Add(Stat::TURN_WAITS);
+            if (pop_count < revolution_count)
+            {
+                // Earlier revolutions still have to pop from and push to
+                // this slot.
+                backoff.Wait(2U * (revolution_count - pop_count));
+            }
             r_count = _r_count.load(std::memory_order_relaxed);
         }
+        _stats.Add(Stat::RETRIES);
+    }
+}
+
+// Reserves a contiguous run of up to n tickets with a single CAS on _w_count.
+// The run stops at the first slot that is not free for the current
+// revolution, so a nearly full queue accepts a partial batch. Returns the
+// number of elements pushed.
+template <typename T, size_t size, typename Layout, typename StatsPolicy, typename Backoff>
+size_t Queue<T, size, Layout, StatsPolicy, Backoff>::PushBulk(const T *elements, const size_t n)
+{
+    static_assert(TRIVIAL, "PushBulk needs a trivial T");
+    const size_t limit = n < size ? n : size;
+    if (limit == 0U)
+    {
+        return 0U;
+    }
+
+    _stats.Add(Stat::OPERATIONS);
+    Backoff backoff;
+    size_t w_count = _w_count.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        size_t count = 0U;
+        bool our_turn = true;
+
+        while (count < limit)
+        {
+            const size_t ticket = w_count + count;
+            const Slot &slot = _data[ticket % size];
+
+            const size_t push_count =
+                slot.push_count.load(std::memory_order_acquire);
+            const size_t pop_count =
+                slot.pop_count.load(std::memory_order_acquire);
+
+            if (push_count > pop_count)
+            {
+                break;
+            }
+            if (push_count != ticket / size)
+            {
+                our_turn = false;
+                break;
+            }
+            ++count;
+        }
+
+        if (count == 0U)
+        {
+            if (our_turn)
+            {
+                _stats.Add(Stat::FULL_REJECTIONS);
+                return 0U;
+            }
+            _stats.Add(Stat::TURN_WAITS);
+            _stats.Add(Stat::RETRIES);
+            backoff.Pause();
+            w_count = _w_count.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if (_w_count.compare_exchange_weak(w_count, w_count + count,
+                                           std::memory_order_relaxed))
+        {
+            for (size_t i = 0U; i < count; ++i)
+            {
+                const size_t ticket = w_count + i;
+                Slot &slot = _data[ticket % size];
+                slot.val = elements[i];
+                slot.push_count.store(ticket / size + 1U,
+                                      std::memory_order_release);
+            }
+            return count;
+        }
+        _stats.Add(Stat::CAS_FAILURES);
+        _stats.Add(Stat::RETRIES);
+        backoff.Pause();
+    }
+}
+
+// Reserves a contiguous run of up to max_n filled slots with a single CAS on
+// _r_count and drains them into elements. Returns the number of elements
+// popped, which is less than max_n when the queue runs dry.
+template <typename T, size_t size, typename Layout, typename StatsPolicy, typename Backoff>
+size_t Queue<T, size, Layout, StatsPolicy, Backoff>::PopBulk(T *elements, const size_t max_n)
+{
+    static_assert(TRIVIAL, "PopBulk needs a trivial T");
+    const size_t limit = max_n < size ? max_n : size;
+    if (limit == 0U)
+    {
+        return 0U;
+    }
+
+    _stats.Add(Stat::OPERATIONS);
+    Backoff backoff;
+    size_t r_count = _r_count.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        size_t count = 0U;
+        bool our_turn = true;
+
+        while (count < limit)
+        {
+            const size_t ticket = r_count + count;
+            const Slot &slot = _data[ticket % size];
+
+            const size_t pop_count =
+                slot.pop_count.load(std::memory_order_acquire);
+            const size_t push_count =
+                slot.push_count.load(std::memory_order_acquire);
+
+            if (pop_count == push_count)
+            {
+                break;
+            }
+            if (pop_count != ticket / size)
+            {
+                our_turn = false;
+                break;
+            }
+            ++count;
+        }
+
+        if (count == 0U)
+        {
+            const size_t current = _r_count.load(std::memory_order_relaxed);
+            // As in Pop, only report empty for the current read index.
+            if (our_turn && current == r_count)
+            {
+                _stats.Add(Stat::EMPTY_REJECTIONS);
+                return 0U;
+            }
+            if (!our_turn)
+            {
+                _stats.Add(Stat::TURN_WAITS);
+                backoff.Pause();
+            }
+            _stats.Add(Stat::RETRIES);
+            r_count = current;
+            continue;
+        }
+
+        if (_r_count.compare_exchange_weak(r_count, r_count + count,
+                                           std::memory_order_relaxed))
+        {
+            for (size_t i = 0U; i < count; ++i)
+            {
+                const size_t ticket = r_count + i;
+                Slot &slot = _data[ticket % size];
+                elements[i] = slot.val;
+                slot.pop_count.store(ticket / size + 1U,
+                                     std::memory_order_release);
+            }
+            return count;
+        }
+        _stats.Add(Stat::CAS_FAILURES);
+        _stats.Add(Stat::RETRIES);
+        backoff.Pause();
     }
 }
 
@@ -3,18 +3,24 @@
 
 #include <array>
 #include <atomic>
+#include <cassert>
 #include <cstddef>
+#include <cstring>
 #include <type_traits>
 #include <iostream>
 #include <vector>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <stdlib.h>
 #include <condition_variable>
 
 #include <mutex>
 #include <queue>
 
+#include "Layout.hpp"
+#include "Platform.hpp"
+
 template <typename T>
 class LockBasedBuffer {
 public:
@@ -51,7 +57,17 @@ private:
 };
 
 
-template <typename T, size_t size> class RingBuf {
+// A view of up to two pieces of ring memory, as handed out by the zero-copy
+// RingBuf API. `second` is only non-empty when the region wraps past the end
+// of the buffer.
+template <typename U> struct RingRegion {
+    std::span<U> first;
+    std::span<U> second;
+
+    size_t size() const { return first.size() + second.size(); }
+};
+
+template <typename T, size_t size, typename Layout = CompactLayout> class RingBuf {
     static_assert(std::is_trivial<T>::value, "The type T must be trivial");
     static_assert(size > 2, "Buffer size must be bigger than 2");
 
@@ -70,6 +86,16 @@ template <typename T, size_t size> class RingBuf {
     size_t GetFree() const;
     size_t GetAvailable() const;
 
+    // Zero-copy producer API: reserve up to cnt free slots, fill them in
+    // place, then publish the first n of them with WriteCommit(n).
+    RingRegion<T> WriteReserve(size_t cnt);
+    void WriteCommit(size_t cnt);
+
+    // Zero-copy consumer API: view up to cnt available elements in place,
+    // then hand the first n of them back to the producer with ReadRelease(n).
+    RingRegion<const T> ReadAcquire(size_t cnt);
+    void ReadRelease(size_t cnt);
+
   private:
     static size_t CalcFree(const size_t w, const size_t r);
     static size_t CalcAvailable(const size_t w, const size_t r);
@@ -78,21 +104,29 @@ template <typename T, size_t size> class RingBuf {
   private:
     T _data[size];
 
-    std::atomic_size_t _r; 
-    std::atomic_size_t _w; 
+    // Consumer side: the read index and the consumer's last observed _w.
+    alignas(Layout::index_align) std::atomic_size_t _r;
+    mutable size_t _w_cache;
+
+    // Producer side: the write index and the producer's last observed _r.
+    alignas(Layout::index_align) std::atomic_size_t _w;
+    size_t _r_cache;
 };
 
-template <typename T, size_t size>
-RingBuf<T, size>::RingBuf() : _r(0U), _w(0U) {}
+template <typename T, size_t size, typename Layout>
+RingBuf<T, size, Layout>::RingBuf()
+    : _r(0U), _w_cache(0U), _w(0U), _r_cache(0U) {}
 
-template <typename T, size_t size>
-bool RingBuf<T, size>::Write(const T *data, const size_t cnt) {
+template <typename T, size_t size, typename Layout>
+bool RingBuf<T, size, Layout>::Write(const T *data, const size_t cnt) {
     
     size_t w = _w.load(std::memory_order_relaxed);
-    const size_t r = _r.load(std::memory_order_acquire);
 
-    if (CalcFree(w, r) < cnt) {
-        return false;
+    if (CalcFree(w, _r_cache) < cnt) {
+        _r_cache = _r.load(std::memory_order_acquire);
+        if (CalcFree(w, _r_cache) < cnt) {
+            return false;
+        }
     }
     if (w + cnt <= size) {
         memcpy(&_data[w], &data[0], cnt * sizeof(T));
@@ -115,13 +149,15 @@ bool RingBuf<T, size>::Write(const T *data, const size_t cnt) {
     return true;
 }
 
-template <typename T, size_t size>
-bool RingBuf<T, size>::Read(T *data, const size_t cnt) {
+template <typename T, size_t size, typename Layout>
+bool RingBuf<T, size, Layout>::Read(T *data, const size_t cnt) {
     size_t r = _r.load(std::memory_order_relaxed);
-    const size_t w = _w.load(std::memory_order_acquire);
 
-    if (CalcAvailable(w, r) < cnt) {
-        return false;
+    if (CalcAvailable(_w_cache, r) < cnt) {
+        _w_cache = _w.load(std::memory_order_acquire);
+        if (CalcAvailable(_w_cache, r) < cnt) {
+            return false;
+        }
     }
     if (r + cnt <= size) {
         memcpy(&data[0], &_data[r], cnt * sizeof(T));
@@ -147,13 +183,15 @@ bool RingBuf<T, size>::Read(T *data, const size_t cnt) {
     return true;
 }
 
-template <typename T, size_t size>
-bool RingBuf<T, size>::Peek(T *data, const size_t cnt) const {
+template <typename T, size_t size, typename Layout>
+bool RingBuf<T, size, Layout>::Peek(T *data, const size_t cnt) const {
     const size_t r = _r.load(std::memory_order_relaxed);
-    const size_t w = _w.load(std::memory_order_acquire);
 
-    if (CalcAvailable(w, r) < cnt) {
-        return false;
+    if (CalcAvailable(_w_cache, r) < cnt) {
+        _w_cache = _w.load(std::memory_order_acquire);
+        if (CalcAvailable(_w_cache, r) < cnt) {
+            return false;
+        }
     }
     if (r + cnt <= size) {
         memcpy(&data[0], &_data[r], cnt * sizeof(T));
@@ -167,13 +205,15 @@ bool RingBuf<T, size>::Peek(T *data, const size_t cnt) const {
     return true;
 }
 
-template <typename T, size_t size>
-bool RingBuf<T, size>::Skip(const size_t cnt) {
+template <typename T, size_t size, typename Layout>
+bool RingBuf<T, size, Layout>::Skip(const size_t cnt) {
     size_t r = _r.load(std::memory_order_relaxed);
-    const size_t w = _w.load(std::memory_order_acquire);
 
-    if (CalcAvailable(w, r) < cnt) {
-        return false;
+    if (CalcAvailable(_w_cache, r) < cnt) {
+        _w_cache = _w.load(std::memory_order_acquire);
+        if (CalcAvailable(_w_cache, r) < cnt) {
+            return false;
+        }
     }
 
     r += cnt;
@@ -185,15 +225,80 @@ bool RingBuf<T, size>::Skip(const size_t cnt) {
     return true;
 }
 
-template <typename T, size_t size> size_t RingBuf<T, size>::GetFree() const {
+template <typename T, size_t size, typename Layout>
+RingRegion<T> RingBuf<T, size, Layout>::WriteReserve(size_t cnt) {
+    const size_t w = _w.load(std::memory_order_relaxed);
+
+    if (CalcFree(w, _r_cache) < cnt) {
+        _r_cache = _r.load(std::memory_order_acquire);
+        const size_t free = CalcFree(w, _r_cache);
+        if (free < cnt) {
+            cnt = free;
+        }
+    }
+
+    if (w + cnt <= size) {
+        return {std::span<T>(&_data[w], cnt), std::span<T>()};
+    }
+    const size_t linear_free = size - w;
+    return {std::span<T>(&_data[w], linear_free),
+            std::span<T>(&_data[0], cnt - linear_free)};
+}
+
+template <typename T, size_t size, typename Layout>
+void RingBuf<T, size, Layout>::WriteCommit(const size_t cnt) {
+    size_t w = _w.load(std::memory_order_relaxed);
+    assert(cnt <= CalcFree(w, _r_cache));
+
+    w += cnt;
+    if (w >= size) {
+        w -= size;
+    }
+    _w.store(w, std::memory_order_release);
+}
+
+template <typename T, size_t size, typename Layout>
+RingRegion<const T> RingBuf<T, size, Layout>::ReadAcquire(size_t cnt) {
+    const size_t r = _r.load(std::memory_order_relaxed);
+
+    if (CalcAvailable(_w_cache, r) < cnt) {
+        _w_cache = _w.load(std::memory_order_acquire);
+        const size_t available = CalcAvailable(_w_cache, r);
+        if (available < cnt) {
+            cnt = available;
+        }
+    }
+
+    if (r + cnt <= size) {
+        return {std::span<const T>(&_data[r], cnt), std::span<const T>()};
+    }
+    const size_t linear_available = size - r;
+    return {std::span<const T>(&_data[r], linear_available),
+            std::span<const T>(&_data[0], cnt - linear_available)};
+}
+
+template <typename T, size_t size, typename Layout>
+void RingBuf<T, size, Layout>::ReadRelease(const size_t cnt) {
+    size_t r = _r.load(std::memory_order_relaxed);
+    assert(cnt <= CalcAvailable(_w_cache, r));
+
+    r += cnt;
+    if (r >= size) {
+        r -= size;
+    }
+    _r.store(r, std::memory_order_release);
+}
+
+template <typename T, size_t size, typename Layout>
+size_t RingBuf<T, size, Layout>::GetFree() const {
     const size_t w = _w.load(std::memory_order_relaxed);
     const size_t r = _r.load(std::memory_order_acquire);
 
     return CalcFree(w, r);
 }
 
-template <typename T, size_t size>
-size_t RingBuf<T, size>::GetAvailable() const {
+template <typename T, size_t size, typename Layout>
+size_t RingBuf<T, size, Layout>::GetAvailable() const {
     const size_t r = _r.load(std::memory_order_relaxed);
     const size_t w = _w.load(std::memory_order_acquire);
 
@@ -201,27 +306,27 @@ size_t RingBuf<T, size>::GetAvailable() const {
 }
 
 
-template <typename T, size_t size>
+template <typename T, size_t size, typename Layout>
 template <size_t arr_size>
-bool RingBuf<T, size>::Write(const std::array<T, arr_size> &data) {
+bool RingBuf<T, size, Layout>::Write(const std::array<T, arr_size> &data) {
     return Write(data.begin(), arr_size);
 }
 
-template <typename T, size_t size>
+template <typename T, size_t size, typename Layout>
 template <size_t arr_size>
-bool RingBuf<T, size>::Read(std::array<T, arr_size> &data) {
+bool RingBuf<T, size, Layout>::Read(std::array<T, arr_size> &data) {
     return Read(data.begin(), arr_size);
 }
 
-template <typename T, size_t size>
+template <typename T, size_t size, typename Layout>
 template <size_t arr_size>
-bool RingBuf<T, size>::Peek(std::array<T, arr_size> &data) const {
+bool RingBuf<T, size, Layout>::Peek(std::array<T, arr_size> &data) const {
     return Peek(data.begin(), arr_size);
 }
 
 
-template <typename T, size_t size>
-size_t RingBuf<T, size>::CalcFree(const size_t w, const size_t r) {
+template <typename T, size_t size, typename Layout>
+size_t RingBuf<T, size, Layout>::CalcFree(const size_t w, const size_t r) {
     if (r > w) {
         return (r - w) - 1U;
     } else {
@@ -229,8 +334,8 @@ size_t RingBuf<T, size>::CalcFree(const size_t w, const size_t r) {
     }
 }
 
-template <typename T, size_t size>
-size_t RingBuf<T, size>::CalcAvailable(const size_t w, const size_t r) {
+template <typename T, size_t size, typename Layout>
+size_t RingBuf<T, size, Layout>::CalcAvailable(const size_t w, const size_t r) {
     if (w >= r) {
         return w - r;
     } else {
@@ -238,4 +343,153 @@ size_t RingBuf<T, size>::CalcAvailable(const size_t w, const size_t r) {
     }
 }
 
-#endif 
+// Multi-producer / multi-consumer ring buffer with the same all-or-nothing
+// multi-element Write/Read as RingBuf.
+//
+// Cursors are free-running counters. A writer claims [w, w + cnt) with a CAS on
+// _w_reserve, copies its block in, and then publishes it by advancing
+// _w_commit once every earlier reservation has been committed, so readers only
+// ever see a gap-free prefix. Reads mirror this with _r_reserve/_r_commit, and
+// writers only reuse space that readers have released through _r_commit.
+// All `size` slots are usable.
+template <typename T, size_t size, typename Layout = CompactLayout> class MpmcRingBuf {
+    static_assert(std::is_trivial<T>::value, "The type T must be trivial");
+    static_assert(size > 2, "Buffer size must be bigger than 2");
+
+  public:
+    MpmcRingBuf();
+
+    bool Write(const T *data, size_t cnt);
+    template <size_t arr_size> bool Write(const std::array<T, arr_size> &data);
+    bool Read(T *data, size_t cnt);
+    template <size_t arr_size> bool Read(std::array<T, arr_size> &data);
+    size_t GetFree() const;
+    size_t GetAvailable() const;
+
+  private:
+    void CopyIn(size_t pos, const T *data, size_t cnt);
+    void CopyOut(size_t pos, T *data, size_t cnt) const;
+
+  private:
+    T _data[size];
+
+    alignas(Layout::index_align) std::atomic_size_t _w_reserve;
+    alignas(Layout::index_align) std::atomic_size_t _w_commit;
+
+    alignas(Layout::index_align) std::atomic_size_t _r_reserve;
+    alignas(Layout::index_align) std::atomic_size_t _r_commit;
+};
+
+template <typename T, size_t size, typename Layout>
+MpmcRingBuf<T, size, Layout>::MpmcRingBuf()
+    : _w_reserve(0U), _w_commit(0U), _r_reserve(0U), _r_commit(0U) {}
+
+template <typename T, size_t size, typename Layout>
+bool MpmcRingBuf<T, size, Layout>::Write(const T *data, const size_t cnt) {
+    if (cnt == 0U) {
+        return true;
+    }
+    if (cnt > size) {
+        return false;
+    }
+
+    size_t w = _w_reserve.load(std::memory_order_relaxed);
+    do {
+        const size_t r = _r_commit.load(std::memory_order_acquire);
+        if (size - (w - r) < cnt) {
+            return false;
+        }
+    } while (!_w_reserve.compare_exchange_weak(w, w + cnt,
+                                               std::memory_order_relaxed));
+
+    CopyIn(w % size, data, cnt);
+
+    // Acquire keeps earlier writers' blocks ordered before our release, so a
+    // reader that sees our commit also sees theirs.
+    while (_w_commit.load(std::memory_order_acquire) != w) {
+        CpuRelax();
+    }
+    _w_commit.store(w + cnt, std::memory_order_release);
+
+    return true;
+}
+
+template <typename T, size_t size, typename Layout>
+bool MpmcRingBuf<T, size, Layout>::Read(T *data, const size_t cnt) {
+    if (cnt == 0U) {
+        return true;
+    }
+
+    size_t r = _r_reserve.load(std::memory_order_relaxed);
+    do {
+        const size_t w = _w_commit.load(std::memory_order_acquire);
+        if (w - r < cnt) {
+            return false;
+        }
+    } while (!_r_reserve.compare_exchange_weak(r, r + cnt,
+                                               std::memory_order_relaxed));
+
+    CopyOut(r % size, data, cnt);
+
+    while (_r_commit.load(std::memory_order_acquire) != r) {
+        CpuRelax();
+    }
+    _r_commit.store(r + cnt, std::memory_order_release);
+
+    return true;
+}
+
+template <typename T, size_t size, typename Layout>
+size_t MpmcRingBuf<T, size, Layout>::GetFree() const {
+    const size_t w = _w_reserve.load(std::memory_order_relaxed);
+    const size_t r = _r_commit.load(std::memory_order_acquire);
+
+    return w - r < size ? size - (w - r) : 0U;
+}
+
+template <typename T, size_t size, typename Layout>
+size_t MpmcRingBuf<T, size, Layout>::GetAvailable() const {
+    const size_t r = _r_reserve.load(std::memory_order_relaxed);
+    const size_t w = _w_commit.load(std::memory_order_acquire);
+
+    return w > r ? w - r : 0U;
+}
+
+template <typename T, size_t size, typename Layout>
+template <size_t arr_size>
+bool MpmcRingBuf<T, size, Layout>::Write(const std::array<T, arr_size> &data) {
+    return Write(data.begin(), arr_size);
+}
+
+template <typename T, size_t size, typename Layout>
+template <size_t arr_size>
+bool MpmcRingBuf<T, size, Layout>::Read(std::array<T, arr_size> &data) {
+    return Read(data.begin(), arr_size);
+}
+
+template <typename T, size_t size, typename Layout>
+void MpmcRingBuf<T, size, Layout>::CopyIn(const size_t pos, const T *data,
+                                          const size_t cnt) {
+    if (pos + cnt <= size) {
+        memcpy(&_data[pos], &data[0], cnt * sizeof(T));
+    } else {
+        const size_t linear_free = size - pos;
+        memcpy(&_data[pos], &data[0], linear_free * sizeof(T));
+        memcpy(&_data[0], &data[linear_free], (cnt - linear_free) * sizeof(T));
+    }
+}
+
+template <typename T, size_t size, typename Layout>
+void MpmcRingBuf<T, size, Layout>::CopyOut(const size_t pos, T *data,
+                                           const size_t cnt) const {
+    if (pos + cnt <= size) {
+        memcpy(&data[0], &_data[pos], cnt * sizeof(T));
+    } else {
+        const size_t linear_available = size - pos;
+        memcpy(&data[0], &_data[pos], linear_available * sizeof(T));
+        memcpy(&data[linear_available], &_data[0],
+               (cnt - linear_available) * sizeof(T));
+    }
+}
+
+#endif
@@ -0,0 +1,323 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "EventCount.hpp"
+#include "Layout.hpp"
+#include "NodePool.hpp"
+#include "Platform.hpp"
+#include "Queue.hpp"
+#include "WorkStealingDeque.hpp"
+
+// Fixed-size work-stealing thread pool.
+//
+// Every worker owns a WorkStealingDeque. A task spawned on a worker goes to
+// the bottom of that worker's deque and is normally popped from there by the
+// same worker, so local spawn and pop touch no contended cache line. An idle
+// worker steals from the top of other deques, trying every victim starting
+// from a random one, and then checks the injection Queue that receives tasks
+// submitted from outside the pool. Workers with nothing to do park on an
+// EventCount; spawning notifies it, which costs a fence and a load while every
+// worker is busy.
+//
+// Tasks are allocated from the NodePool. A task that cannot be queued because
+// the injection queue is full runs inline on the submitting thread. An
+// exception thrown by a submitted task is caught on the thread that ran it;
+// the first one is kept for Rethrow, and the task is freed either way.
+class ThreadPool {
+  public:
+    // Type-erased unit of work. execute runs the task and then frees it.
+    struct Task {
+        void (*execute)(Task *);
+    };
+
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency(), bool pin = false);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    template <typename F> void Submit(F &&function);
+
+    // Rethrows the first exception a Submit task threw since the last call,
+    // if any; one caller at a time. Tasks run through a TaskGroup report to
+    // the group instead.
+    void Rethrow();
+
+    // Runs one queued task on the calling thread. Returns false if none was
+    // found.
+    bool RunOne();
+
+    size_t ThreadCount() const { return _thread_count; }
+
+  private:
+    friend class TaskGroup;
+
+    static constexpr size_t INJECTION_SIZE = 4096U;
+    static constexpr int SPIN_ROUNDS = 64;
+
+    // _exception_state values.
+    static constexpr int NO_EXCEPTION = 0;
+    static constexpr int STORING_EXCEPTION = 1;
+    static constexpr int EXCEPTION_STORED = 2;
+
+    template <typename F> struct FunctionTask : Task {
+        F function;
+        ThreadPool *pool;
+
+        FunctionTask(F &&f, ThreadPool *owner) : Task{&Execute}, function(std::move(f)), pool(owner) {}
+
+        static void Execute(Task *task) {
+            FunctionTask *self = static_cast<FunctionTask *>(task);
+            ThreadPool *owner = self->pool;
+            try {
+                self->function();
+            } catch (...) {
+                owner->Fail(std::current_exception());
+            }
+            PoolAllocator::destroy(self);
+        }
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Worker {
+        WorkStealingDeque<Task *> deque;
+        std::thread thread;
+    };
+
+    struct Current {
+        ThreadPool *pool = nullptr;
+        size_t index = 0U;
+    };
+
+    static Current &CurrentWorker();
+    static size_t Random(size_t bound);
+
+    void Spawn(Task *task);
+    // index is the calling worker, or _thread_count for other threads.
+    bool FindTask(size_t index, Task *&task);
+    void WorkerLoop(size_t index, bool pin);
+    // Keeps exception unless an earlier one is still waiting for Rethrow.
+    void Fail(std::exception_ptr exception);
+
+    size_t _thread_count;
+    std::unique_ptr<Worker[]> _workers;
+    std::unique_ptr<Queue<Task *, INJECTION_SIZE>> _injection;
+    EventCount _idle;
+    std::atomic<bool> _stop{false};
+    std::atomic<int> _exception_state{NO_EXCEPTION};
+    std::exception_ptr _exception;
+};
+
+// Fork-join scope over a ThreadPool. Run spawns a task; Wait helps execute
+// pool tasks until every task started through this group has finished, then
+// rethrows the first exception one of them threw. Groups nest: a task may
+// open its own group and Wait on it.
+class TaskGroup {
+  public:
+    explicit TaskGroup(ThreadPool &pool) : _pool(pool) {}
+    ~TaskGroup();
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    template <typename F> void Run(F &&function);
+    void Wait();
+
+  private:
+    template <typename F> struct GroupTask : ThreadPool::Task {
+        F function;
+        TaskGroup *group;
+
+        GroupTask(F &&f, TaskGroup *owner) : Task{&Execute}, function(std::move(f)), group(owner) {}
+
+        static void Execute(ThreadPool::Task *task) {
+            GroupTask *self = static_cast<GroupTask *>(task);
+            TaskGroup *owner = self->group;
+            try {
+                self->function();
+            } catch (...) {
+                if (!owner->_failed.exchange(true, std::memory_order_relaxed)) {
+                    owner->_exception = std::current_exception();
+                }
+            }
+            PoolAllocator::destroy(self);
+            // The group may be gone as soon as this lands.
+            owner->_pending.fetch_sub(1U, std::memory_order_release);
+        }
+    };
+
+    void Join();
+
+    ThreadPool &_pool;
+    std::atomic<size_t> _pending{0U};
+    std::atomic<bool> _failed{false};
+    std::exception_ptr _exception;
+};
+
+inline ThreadPool::ThreadPool(size_t threads, bool pin)
+    : _thread_count(threads > 0U ? threads : 1U), _workers(new Worker[_thread_count]),
+      _injection(new Queue<Task *, INJECTION_SIZE>()) {
+    for (size_t i = 0; i < _thread_count; ++i) {
+        _workers[i].thread = std::thread(&ThreadPool::WorkerLoop, this, i, pin);
+    }
+}
+
+// Queued tasks are still run; workers exit once they find nothing to do.
+inline ThreadPool::~ThreadPool() {
+    _stop.store(true, std::memory_order_release);
+    _idle.NotifyAll();
+    for (size_t i = 0; i < _thread_count; ++i) {
+        _workers[i].thread.join();
+    }
+}
+
+inline ThreadPool::Current &ThreadPool::CurrentWorker() {
+    static thread_local Current current;
+    return current;
+}
+
+inline size_t ThreadPool::Random(size_t bound) {
+    static thread_local uint64_t state =
+        0x9E3779B97F4A7C15ULL ^ reinterpret_cast<uintptr_t>(&state);
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return static_cast<size_t>(state % bound);
+}
+
+template <typename F> void ThreadPool::Submit(F &&function) {
+    using Function = std::decay_t<F>;
+    Spawn(PoolAllocator::create<FunctionTask<Function>>(Function(std::forward<F>(function)), this));
+}
+
+inline void ThreadPool::Fail(std::exception_ptr exception) {
+    int expected = NO_EXCEPTION;
+    if (_exception_state.compare_exchange_strong(expected, STORING_EXCEPTION, std::memory_order_acquire,
+                                                 std::memory_order_relaxed)) {
+        _exception = std::move(exception);
+        _exception_state.store(EXCEPTION_STORED, std::memory_order_release);
+    }
+}
+
+inline void ThreadPool::Rethrow() {
+    if (_exception_state.load(std::memory_order_acquire) != EXCEPTION_STORED) {
+        return;
+    }
+    std::exception_ptr exception = std::move(_exception);
+    _exception = nullptr;
+    _exception_state.store(NO_EXCEPTION, std::memory_order_release);
+    std::rethrow_exception(exception);
+}
+
+inline void ThreadPool::Spawn(Task *task) {
+    const Current &current = CurrentWorker();
+    if (current.pool == this) {
+        _workers[current.index].deque.Push(task);
+    } else if (!_injection->Push(task)) {
+        task->execute(task);
+        return;
+    }
+    _idle.NotifyOne();
+}
+
+inline bool ThreadPool::FindTask(size_t index, Task *&task) {
+    if (index < _thread_count && _workers[index].deque.Pop(task)) {
+        return true;
+    }
+
+    const size_t start = Random(_thread_count);
+    for (size_t i = 0; i < _thread_count; ++i) {
+        const size_t victim = (start + i) % _thread_count;
+        if (victim == index) {
+            continue;
+        }
+        // A failed Steal may only mean another thief won; retry while the
+        // victim still has work.
+        WorkStealingDeque<Task *> &deque = _workers[victim].deque;
+        while (!deque.Empty()) {
+            if (deque.Steal(task)) {
+                return true;
+            }
+        }
+    }
+
+    return _injection->Pop(task);
+}
+
+inline bool ThreadPool::RunOne() {
+    const Current &current = CurrentWorker();
+    Task *task;
+    if (!FindTask(current.pool == this ? current.index : _thread_count, task)) {
+        return false;
+    }
+    task->execute(task);
+    return true;
+}
+
+inline void ThreadPool::WorkerLoop(size_t index, bool pin) {
+    if (pin) {
+        const unsigned cpus = std::thread::hardware_concurrency();
+        PinCurrentThread(cpus > 0U ? index % cpus : index);
+    }
+    CurrentWorker() = Current{this, index};
+
+    Task *task;
+    while (true) {
+        bool found = false;
+        for (int spin = 0; spin < SPIN_ROUNDS && !found; ++spin) {
+            found = FindTask(index, task);
+            if (!found) {
+                CpuRelax();
+            }
+        }
+        if (!found) {
+            const EventCount::Key key = _idle.PrepareWait();
+            if (FindTask(index, task)) {
+                _idle.CancelWait();
+            } else if (_stop.load(std::memory_order_acquire)) {
+                _idle.CancelWait();
+                break;
+            } else {
+                _idle.Wait(key);
+                continue;
+            }
+        }
+        task->execute(task);
+    }
+
+    CurrentWorker() = Current{};
+}
+
+template <typename F> void TaskGroup::Run(F &&function) {
+    using Function = std::decay_t<F>;
+    _pending.fetch_add(1U, std::memory_order_relaxed);
+    _pool.Spawn(PoolAllocator::create<GroupTask<Function>>(Function(std::forward<F>(function)), this));
+}
+
+inline void TaskGroup::Join() {
+    while (_pending.load(std::memory_order_acquire) != 0U) {
+        if (!_pool.RunOne()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+inline void TaskGroup::Wait() {
+    Join();
+    if (_failed.load(std::memory_order_relaxed)) {
+        std::exception_ptr exception = std::move(_exception);
+        _exception = nullptr;
+        _failed.store(false, std::memory_order_relaxed);
+        std::rethrow_exception(exception);
+    }
+}
+
+inline TaskGroup::~TaskGroup() { Join(); }
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef WORK_STEALING_DEQUE_HPP
+#define WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "Layout.hpp"
+
+// Chase & Lev's dynamic circular work-stealing deque, with the C11 memory
+// orderings from Lê, Pop, Cohen & Zappa Nardelli (PPoPP 2013).
+//
+// One owner thread pushes and pops at the bottom; any number of thieves steal
+// from the top. The owner's Push and Pop are plain loads and stores (plus one
+// fence in Pop); only a Pop racing a thief for the last element, and every
+// Steal, use a CAS on _top.
+//
+// When the owner fills the ring it copies the live range into one twice the
+// size. Thieves may still be reading the old ring, so old rings are kept
+// until the deque is destroyed; the total is less than twice the peak size.
+//
+// Elements are copied through relaxed atomics and must be trivially copyable,
+// which in practice means pointers to tasks.
+template <typename T> class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable<T>::value, "The type T must be trivially copyable");
+
+  public:
+    explicit WorkStealingDeque(size_t capacity = 64U);
+    ~WorkStealingDeque();
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    // Owner only.
+    void Push(const T &element);
+    bool Pop(T &element);
+
+    // Any thread. Returns false when the deque looked empty or another thread
+    // won the race for the top element.
+    bool Steal(T &element);
+
+    // Approximate when called concurrently.
+    size_t Size() const;
+    bool Empty() const { return Size() == 0U; }
+
+  private:
+    struct Ring {
+        int64_t capacity;
+        int64_t mask;
+        Ring *retired;
+        std::atomic<T> *slots;
+
+        explicit Ring(int64_t ring_capacity)
+            : capacity(ring_capacity), mask(ring_capacity - 1), retired(nullptr),
+              slots(new std::atomic<T>[static_cast<size_t>(ring_capacity)]) {}
+        ~Ring() { delete[] slots; }
+
+        T Get(int64_t index) const { return slots[index & mask].load(std::memory_order_relaxed); }
+        void Put(int64_t index, const T &element) {
+            slots[index & mask].store(element, std::memory_order_relaxed);
+        }
+    };
+
+    Ring *Grow(Ring *ring, int64_t bottom, int64_t top);
+
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> _top;
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> _bottom;
+    std::atomic<Ring *> _ring;
+};
+
+template <typename T>
+WorkStealingDeque<T>::WorkStealingDeque(size_t capacity) : _top(0), _bottom(0), _ring(nullptr) {
+    size_t rounded = 2U;
+    while (rounded < capacity) {
+        rounded <<= 1U;
+    }
+    _ring.store(new Ring(static_cast<int64_t>(rounded)), std::memory_order_relaxed);
+}
+
+template <typename T> WorkStealingDeque<T>::~WorkStealingDeque() {
+    Ring *ring = _ring.load(std::memory_order_relaxed);
+    while (ring != nullptr) {
+        Ring *retired = ring->retired;
+        delete ring;
+        ring = retired;
+    }
+}
+
+template <typename T>
+typename WorkStealingDeque<T>::Ring *WorkStealingDeque<T>::Grow(Ring *ring, int64_t bottom, int64_t top) {
+    Ring *bigger = new Ring(ring->capacity * 2);
+    for (int64_t i = top; i < bottom; ++i) {
+        bigger->Put(i, ring->Get(i));
+    }
+    bigger->retired = ring;
+    _ring.store(bigger, std::memory_order_release);
+    return bigger;
+}
+
+template <typename T> void WorkStealingDeque<T>::Push(const T &element) {
+    const int64_t bottom = _bottom.load(std::memory_order_relaxed);
+    const int64_t top = _top.load(std::memory_order_acquire);
+    Ring *ring = _ring.load(std::memory_order_relaxed);
+    if (bottom - top > ring->capacity - 1) {
+        ring = Grow(ring, bottom, top);
+    }
+    ring->Put(bottom, element);
+    // Publishes the element to thieves. The paper's release fence followed by
+    // a relaxed store is equivalent; a release store is what TSan can see.
+    _bottom.store(bottom + 1, std::memory_order_release);
+}
+
+template <typename T> bool WorkStealingDeque<T>::Pop(T &element) {
+    const int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+    Ring *ring = _ring.load(std::memory_order_relaxed);
+    _bottom.store(bottom, std::memory_order_relaxed);
+    // Orders the claim on the bottom slot before reading _top; pairs with the
+    // fence in Steal.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = _top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    element = ring->Get(bottom);
+    if (top == bottom) {
+        // Last element: race the thieves for it.
+        const bool won = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                      std::memory_order_relaxed);
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+template <typename T> bool WorkStealingDeque<T>::Steal(T &element) {
+    int64_t top = _top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+    if (top >= bottom) {
+        return false;
+    }
+
+    Ring *ring = _ring.load(std::memory_order_acquire);
+    const T stolen = ring->Get(top);
+    if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+        return false;
+    }
+    element = stolen;
+    return true;
+}
+
+template <typename T> size_t WorkStealingDeque<T>::Size() const {
+    const int64_t bottom = _bottom.load(std::memory_order_relaxed);
+    const int64_t top = _top.load(std::memory_order_relaxed);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0U;
+}
+
+#endif
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "../include/LockBasedLinkedList.hpp"
+#include "../include/LockFreeHashMap.hpp"
+
+
+// Baseline: std::unordered_map behind a single mutex.
+class MutexHashMap {
+public:
+    bool insert(int k, void* value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return map.emplace(k, value).second;
+    }
+
+    bool deleteNode(int k) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return map.erase(k) == 1;
+    }
+
+    bool search(int k) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return map.find(k) != map.end();
+    }
+
+private:
+    std::unordered_map<int, void*> map;
+    std::mutex mutex;
+};
+
+// 80% search, 10% insert, 10% delete over a half-full key range.
+template <typename MapType>
+void testMap(MapType& map, int numThreads, const std::string& name, int keyRange, int opsPerThread) {
+    for (int key = 0; key < keyRange; key += 2) {
+        map.insert(key, nullptr);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.push_back(std::thread([&map, i, keyRange, opsPerThread]() {
+            unsigned seed = static_cast<unsigned>(i) * 2654435761U + 1U;
+            for (int j = 0; j < opsPerThread; ++j) {
+                seed = seed * 1103515245U + 12345U;
+                const int key = static_cast<int>((seed >> 8) % keyRange);
+                const unsigned op = (seed >> 24) % 100U;
+                if (op < 80U) {
+                    map.search(key);
+                } else if (op < 90U) {
+                    map.insert(key, nullptr);
+                } else {
+                    map.deleteNode(key);
+                }
+            }
+        }));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    const double totalOps = static_cast<double>(numThreads) * opsPerThread;
+    std::cout << name << " (" << numThreads << " threads): " << totalOps / duration.count()
+              << " ops/sec (" << duration.count() * 1e9 / totalOps << " ns/op).\n";
+}
+
+int main() {
+    const int keyRange = 100000;
+
+    std::cout << "Testing Hash Map Performance (80/10/10 mix, " << keyRange << " keys)..." << std::endl;
+    for (int numThreads : {1, 4, 16}) {
+        // The list is O(n) per operation, so it runs on a smaller key range.
+        LockBasedLinkedList<> lockBasedList;
+        testMap(lockBasedList, numThreads, "Lock-Based List (5000 keys)", 5000, 2000);
+
+        MutexHashMap mutexMap;
+        testMap(mutexMap, numThreads, "Mutex unordered_map", keyRange, 50000);
+
+        HashMap<HazardPointers> hazardMap;
+        testMap(hazardMap, numThreads, "Lock-Free Hash Map (hazard pointers)", keyRange, 50000);
+
+        HashMap<EpochReclaimer> epochMap;
+        testMap(epochMap, numThreads, "Lock-Free Hash Map (epochs)", keyRange, 50000);
+    }
+
+    return 0;
+}
@@ -5,19 +5,89 @@
 #include <chrono>
 #include <queue>
 #include <mutex>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include "../include/LockBasedLinkedList.hpp"
 #include "../include/LockFreeLinkedList.hpp"
+#include "../include/LockFreeSkipList.hpp"
+#include "../include/NodePool.hpp"
 
 
-void testLockBasedList(LockBasedLinkedList& list, int numThreads) {
+// The original shared_ptr based lock-free list, kept only as a benchmark
+// baseline for the per-operation cost of reference counting. Its deleteNode
+// does not mark nodes, so concurrent inserts next to a deleted node can be lost.
+class SharedPtrLinkedList {
+    struct Node {
+        int key;
+        void* value;
+        std::shared_ptr<Node> next;
+
+        Node(int k, void* v = nullptr) : key(k), value(v), next(nullptr) {}
+    };
+
+public:
+    SharedPtrLinkedList() {
+        head = std::make_shared<Node>(std::numeric_limits<int>::min());
+        head->next = std::make_shared<Node>(std::numeric_limits<int>::max());
+    }
+
+    bool insert(int k, void* value) {
+        auto [prev, next] = searchFrom(k);
+        if (next && next->key == k) return false;
+
+        auto newNode = std::make_shared<Node>(k, value);
+        newNode->next = next;
+        return std::atomic_compare_exchange_strong(&prev->next, &next, newNode);
+    }
+
+    bool deleteNode(int k) {
+        auto [prev, delNode] = searchFrom(k);
+        if (!delNode || delNode->key != k) return false;
+        return std::atomic_compare_exchange_strong(&prev->next, &delNode, delNode->next);
+    }
+
+    bool search(int key) {
+        std::shared_ptr<Node> current = head;
+        while (current != nullptr) {
+            if (current->key == key) return true;
+            current = current->next;
+        }
+        return false;
+    }
+
+private:
+    std::shared_ptr<Node> head;
+
+    std::pair<std::shared_ptr<Node>, std::shared_ptr<Node>> searchFrom(int k) {
+        auto curr = head;
+        auto next = curr->next;
+        while (next && next->key <= k) {
+            if (next->key == k) return {curr, next};
+            curr = next;
+            next = curr->next;
+        }
+        return {curr, next};
+    }
+};
+
+template <typename Reclaimer>
+using IntLinkedList = LinkedList<int, void*, std::less<int>, Reclaimer>;
+
+
+template <typename ListType>
+void testList(ListType& list, int numThreads, const std::string& name) {
+    const int opsPerThread = 1000;
     auto start = std::chrono::high_resolution_clock::now();
     
-    // Perform insertions for a long time (30 seconds)
+    // Perform insertions
     std::vector<std::thread> threads;
     for (int i = 0; i < numThreads; ++i) {
         threads.push_back(std::thread([&list, i]() {
-            for (int j = 0; j < 1000; ++j) {  // Each thread performs 1000 inserts
-                list.insert(i * 1000 + j, nullptr);
+            for (int j = 0; j < opsPerThread; ++j) {  // Each thread performs 1000 inserts
+                list.insert(i * opsPerThread + j, nullptr);
             }
         }));
     }
@@ -25,12 +95,12 @@ void testLockBasedList(LockBasedLinkedList& list, int numThreads) {
         t.join();
     }
     
-    // Perform searches for a long time (30 seconds)
+    // Perform searches
     threads.clear();
     for (int i = 0; i < numThreads; ++i) {
         threads.push_back(std::thread([&list, i]() {
-            for (int j = 0; j < 1000; ++j) {  // Each thread performs 1000 searches
-                list.search(i * 1000 + j);
+            for (int j = 0; j < opsPerThread; ++j) {  // Each thread performs 1000 searches
+                list.search(i * opsPerThread + j);
             }
         }));
     }
@@ -38,12 +108,12 @@ void testLockBasedList(LockBasedLinkedList& list, int numThreads) {
         t.join();
     }
     
-    // Perform deletions for a long time (30 seconds)
+    // Perform deletions
     threads.clear();
     for (int i = 0; i < numThreads; ++i) {
         threads.push_back(std::thread([&list, i]() {
-            for (int j = 0; j < 1000; ++j) {  // Each thread performs 1000 deletions
-                list.deleteNode(i * 1000 + j);
+            for (int j = 0; j < opsPerThread; ++j) {  // Each thread performs 1000 deletions
+                list.deleteNode(i * opsPerThread + j);
             }
         }));
     }
@@ -53,44 +123,250 @@ void testLockBasedList(LockBasedLinkedList& list, int numThreads) {
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> duration = end - start;
-    std::cout << "Lock-Based List operations took: " << duration.count() << " seconds.\n";
+    const double totalOps = 3.0 * numThreads * opsPerThread;
+    std::cout << name << " operations took: " << duration.count() << " seconds ("
+              << duration.count() * 1e9 / totalOps << " ns/op).\n";
 }
 
-void testLockFreeList(LinkedList& list, int numThreads) {
+// Continuous insert/delete churn over a small key range. Every successful
+// delete retires a node, so this shows whether reclamation keeps up: the
+// number of retired-but-unfreed nodes must stay bounded however long it runs.
+template <typename Reclaimer>
+void testChurn(int numThreads, const std::string& name) {
+    const int opsPerThread = 200000;
+    const int keyRange = 256;
+
+    IntLinkedList<Reclaimer> list;
+    std::atomic<int> running{numThreads};
+    size_t peakRetired = 0;
+
     auto start = std::chrono::high_resolution_clock::now();
-    
-    // Perform insertions for a long time (30 seconds)
+
     std::vector<std::thread> threads;
     for (int i = 0; i < numThreads; ++i) {
-        threads.push_back(std::thread([&list, i]() {
-            for (int j = 0; j < 1000; ++j) {  // Each thread performs 1000 inserts
-                list.insert(i * 1000 + j, nullptr);
+        threads.push_back(std::thread([&list, &running, i]() {
+            unsigned seed = static_cast<unsigned>(i) * 2654435761U + 1U;
+            for (int j = 0; j < opsPerThread; ++j) {
+                seed = seed * 1103515245U + 12345U;
+                const int key = static_cast<int>((seed >> 8) % keyRange);
+                if (seed & 1U) {
+                    list.insert(key, nullptr);
+                } else {
+                    list.deleteNode(key);
+                }
             }
+            running.fetch_sub(1);
         }));
     }
+
+    while (running.load() > 0) {
+        peakRetired = std::max(peakRetired, Reclaimer::RetiredCount());
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
     for (auto& t : threads) {
         t.join();
     }
-    
-    // Perform searches for a long time (30 seconds)
-    threads.clear();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << name << " churn (" << numThreads * opsPerThread << " ops) took: "
+              << duration.count() << " seconds, peak retired nodes: " << peakRetired
+              << ", retired after run: " << Reclaimer::RetiredCount() << "\n";
+}
+
+// Read-mostly mix: 90% search, 5% insert, 5% delete over a prefilled list.
+template <typename ListType>
+void testSearchHeavy(ListType& list, int numThreads, const std::string& name, int keyRange = 2000) {
+    const int opsPerThread = 20000;
+
+    for (int key = 0; key < keyRange; key += 2) {
+        list.insert(key, nullptr);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> threads;
     for (int i = 0; i < numThreads; ++i) {
-        threads.push_back(std::thread([&list, i]() {
-            for (int j = 0; j < 1000; ++j) {  // Each thread performs 1000 searches
-                list.search(i * 1000 + j);
+        threads.push_back(std::thread([&list, i, keyRange]() {
+            unsigned seed = static_cast<unsigned>(i) * 2654435761U + 1U;
+            for (int j = 0; j < opsPerThread; ++j) {
+                seed = seed * 1103515245U + 12345U;
+                const int key = static_cast<int>((seed >> 8) % keyRange);
+                const unsigned op = (seed >> 24) % 100U;
+                if (op < 90U) {
+                    list.search(key);
+                } else if (op < 95U) {
+                    list.insert(key, nullptr);
+                } else {
+                    list.deleteNode(key);
+                }
             }
         }));
     }
     for (auto& t : threads) {
         t.join();
     }
-    
-    // Perform deletions for a long time (30 seconds)
-    threads.clear();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    const double totalOps = static_cast<double>(numThreads) * opsPerThread;
+    std::cout << name << " 90/5/5 mix: " << totalOps / duration.count() << " ops/sec ("
+              << duration.count() * 1e9 / totalOps << " ns/op).\n";
+}
+
+
+// Lookups that read the payload of every hit: through a void* to separately
+// allocated storage versus a 64-bit key with the value stored in the node.
+void testPayloadLookup(int numThreads) {
+    const int keyRange = 2000;
+    const int opsPerThread = 20000;
+
+    std::vector<uint64_t> payloads(keyRange);
+    IntLinkedList<EpochReclaimer> pointerList;
+    LinkedList<uint64_t, uint64_t, std::less<uint64_t>, EpochReclaimer> inlineList;
+    for (int key = 0; key < keyRange; ++key) {
+        payloads[key] = static_cast<uint64_t>(key) * 3U;
+        pointerList.insert(key, &payloads[key]);
+        inlineList.insert(static_cast<uint64_t>(key), payloads[key]);
+    }
+
+    auto run = [&](const std::string& name, auto&& lookup) {
+        std::atomic<uint64_t> checksum{0};
+        auto start = std::chrono::high_resolution_clock::now();
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i) {
+            threads.push_back(std::thread([&, i]() {
+                unsigned seed = static_cast<unsigned>(i) * 2654435761U + 1U;
+                uint64_t sum = 0;
+                for (int j = 0; j < opsPerThread; ++j) {
+                    seed = seed * 1103515245U + 12345U;
+                    sum += lookup(static_cast<int>((seed >> 8) % keyRange));
+                }
+                checksum.fetch_add(sum);
+            }));
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> duration = end - start;
+        const double totalOps = static_cast<double>(numThreads) * opsPerThread;
+        std::cout << name << " lookups: " << duration.count() * 1e9 / totalOps
+                  << " ns/op (checksum " << checksum.load() << ").\n";
+    };
+
+    run("void* value", [&](int key) -> uint64_t {
+        void* value = nullptr;
+        return pointerList.find(key, value) ? *static_cast<uint64_t*>(value) : 0U;
+    });
+    run("Inline uint64_t value", [&](int key) -> uint64_t {
+        uint64_t value = 0;
+        return inlineList.find(static_cast<uint64_t>(key), value) ? value : 0U;
+    });
+}
+
+// Allocation storm: each thread repeatedly allocates a batch of list-node
+// sized objects and frees them again, half of them after handing them to a
+// neighbour so blocks also migrate between threads.
+template <typename Allocator>
+void testAllocator(int numThreads, const std::string& name) {
+    struct Block {
+        int key;
+        void* value;
+        std::atomic<Block*> next;
+
+        Block(int k) : key(k), value(nullptr), next(nullptr) {}
+    };
+    const int rounds = 2000;
+    const int batch = 256;
+
+    std::vector<std::vector<Block*>> handoff(numThreads);
+    std::vector<std::mutex> handoffMutex(numThreads);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.push_back(std::thread([&, i]() {
+            std::vector<Block*> blocks(batch);
+            for (int r = 0; r < rounds; ++r) {
+                for (int j = 0; j < batch; ++j) {
+                    blocks[j] = Allocator::template create<Block>(j);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(handoffMutex[(i + 1) % numThreads]);
+                    auto& out = handoff[(i + 1) % numThreads];
+                    out.insert(out.end(), blocks.begin(), blocks.begin() + batch / 2);
+                }
+                for (int j = batch / 2; j < batch; ++j) {
+                    Allocator::destroy(blocks[j]);
+                }
+                std::vector<Block*> in;
+                {
+                    std::lock_guard<std::mutex> lock(handoffMutex[i]);
+                    in.swap(handoff[i]);
+                }
+                for (Block* block : in) {
+                    Allocator::destroy(block);
+                }
+            }
+        }));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (auto& leftovers : handoff) {
+        for (Block* block : leftovers) {
+            Allocator::destroy(block);
+        }
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    const double totalOps = static_cast<double>(numThreads) * rounds * batch;
+    std::cout << name << " (" << numThreads << " threads): "
+              << duration.count() * 1e9 / totalOps << " ns per allocate+free.\n";
+}
+
+// Writers churn the list while one reader repeatedly collects the whole key
+// range. Shows how much a full sweep slows the writers down.
+template <typename ListType>
+void testScanUnderWrites(ListType& list, int numThreads, const std::string& name) {
+    const int opsPerThread = 5000;
+    const int keyRange = 2000;
+
+    for (int key = 0; key < keyRange; key += 2) {
+        list.insert(key, nullptr);
+    }
+
+    std::atomic<bool> writing{true};
+    size_t scans = 0;
+    size_t scanned = 0;
+    std::thread reader([&]() {
+        std::vector<std::pair<int, void*>> out;
+        while (writing.load()) {
+            out.clear();
+            scanned += list.collect(0, keyRange, out);
+            ++scans;
+        }
+    });
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> threads;
     for (int i = 0; i < numThreads; ++i) {
         threads.push_back(std::thread([&list, i]() {
-            for (int j = 0; j < 1000; ++j) {  // Each thread performs 1000 deletions
-                list.deleteNode(i * 1000 + j);
+            unsigned seed = static_cast<unsigned>(i) * 2654435761U + 1U;
+            for (int j = 0; j < opsPerThread; ++j) {
+                seed = seed * 1103515245U + 12345U;
+                const int key = static_cast<int>((seed >> 8) % keyRange);
+                if ((seed >> 24) & 1U) {
+                    list.insert(key, nullptr);
+                } else {
+                    list.deleteNode(key);
+                }
             }
         }));
     }
@@ -99,21 +375,176 @@ void testLockFreeList(LinkedList& list, int numThreads) {
     }
 
     auto end = std::chrono::high_resolution_clock::now();
+    writing.store(false);
+    reader.join();
+
     std::chrono::duration<double> duration = end - start;
-    std::cout << "Lock-Free List operations took: " << duration.count() << " seconds.\n";
+    const double totalOps = static_cast<double>(numThreads) * opsPerThread;
+    std::cout << name << ": writers " << duration.count() * 1e9 / totalOps << " ns/op, "
+              << scans << " full scans (" << (scans > 0 ? scanned / scans : 0) << " keys avg).\n";
 }
 
+// Insert/delete churn on a list that counts contention; a smaller key range
+// puts more threads on the same links.
+template <typename Reclaimer>
+void testContention(int numThreads, int keyRange, const std::string& name) {
+    const int opsPerThread = 50000;
 
-int main() {
+    LinkedList<int, void*, std::less<int>, Reclaimer, NewAllocator, ContentionStats> list;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.push_back(std::thread([&list, keyRange, i]() {
+            unsigned seed = static_cast<unsigned>(i) * 2654435761U + 1U;
+            for (int j = 0; j < opsPerThread; ++j) {
+                seed = seed * 1103515245U + 12345U;
+                const int key = static_cast<int>((seed >> 8) % keyRange);
+                if (seed & 1U) {
+                    list.insert(key, nullptr);
+                } else {
+                    list.deleteNode(key);
+                }
+            }
+        }));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    const StatsSnapshot stats = list.stats();
+    std::cout << name << ", " << numThreads << " threads, key range " << keyRange << ": "
+              << stats.operations << " ops, " << stats.cas_failures << " CAS failures, "
+              << stats.retries << " retries (" << stats.RetriesPerOperation() << " per op)\n";
+}
+
+// Checks that the smallest and largest int keys behave like any other key:
+// absent from an empty list, then inserted, found with their values, and
+// erased exactly once. Returns false after printing what went wrong.
+template <typename ListType>
+bool checkBoundaryKeys(ListType& list, const std::string& name) {
+    const int low = std::numeric_limits<int>::min();
+    const int high = std::numeric_limits<int>::max();
+    int lowValue = 1;
+    int highValue = 2;
+    void* value = nullptr;
+
+    const bool ok = !list.search(low) && !list.search(high) && !list.find(high, value) &&
+                    list.insert(high, &highValue) && list.insert(low, &lowValue) &&
+                    !list.insert(high, &lowValue) && !list.insert(low, &highValue) &&
+                    list.find(high, value) && value == &highValue &&
+                    list.find(low, value) && value == &lowValue &&
+                    list.deleteNode(high) && !list.deleteNode(high) && !list.search(high) &&
+                    list.search(low) && list.deleteNode(low) && !list.search(low);
+    std::cout << name << " INT_MIN/INT_MAX keys: " << (ok ? "ok" : "WRONG RESULT") << std::endl;
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
     int numThreads = 10;  // Number of threads performing operations
+    const std::string mode = argc > 1 ? argv[1] : "default";
+
+    if (mode == "churn") {
+        std::cout << "Testing Lock-Free Linked List reclamation under churn..." << std::endl;
+        testChurn<HazardPointers>(numThreads, "Lock-Free List (hazard pointers)");
+        testChurn<EpochReclaimer>(numThreads, "Lock-Free List (epochs)");
+        return 0;
+    }
+
+    if (mode == "reclaim") {
+        std::cout << "Comparing reclamation modes on a search-heavy mix..." << std::endl;
+        LockBasedLinkedList<> lockBasedList;
+        testSearchHeavy(lockBasedList, numThreads, "Lock-Based List");
+        IntLinkedList<HazardPointers> hazardList;
+        testSearchHeavy(hazardList, numThreads, "Lock-Free List (hazard pointers)");
+        IntLinkedList<EpochReclaimer> epochList;
+        testSearchHeavy(epochList, numThreads, "Lock-Free List (epochs)");
+        return 0;
+    }
+
+    if (mode == "alloc") {
+        std::cout << "Comparing node allocators..." << std::endl;
+        for (int threads : {1, 2, 4, numThreads}) {
+            testAllocator<NewAllocator>(threads, "new/delete");
+            testAllocator<PoolAllocator>(threads, "NodePool");
+        }
+        LockBasedLinkedList<int, void*, std::less<int>, PoolAllocator> pooledLockBasedList;
+        testList(pooledLockBasedList, numThreads, "Lock-Based List (NodePool)");
+        LinkedList<int, void*, std::less<int>, EpochReclaimer, PoolAllocator> pooledList;
+        testList(pooledList, numThreads, "Lock-Free List (epochs, NodePool)");
+        return 0;
+    }
+
+    if (mode == "scan") {
+        std::cout << "Testing full-range scans under concurrent writers..." << std::endl;
+        LockBasedLinkedList<> lockBasedList;
+        testScanUnderWrites(lockBasedList, numThreads, "Lock-Based List");
+        IntLinkedList<HazardPointers> hazardList;
+        testScanUnderWrites(hazardList, numThreads, "Lock-Free List (hazard pointers)");
+        IntLinkedList<EpochReclaimer> epochList;
+        testScanUnderWrites(epochList, numThreads, "Lock-Free List (epochs)");
+        return 0;
+    }
+
+    if (mode == "stats") {
+        std::cout << "Counting Lock-Free Linked List contention..." << std::endl;
+        for (int threads : {2, numThreads}) {
+            for (int keyRange : {16, 2000}) {
+                testContention<HazardPointers>(threads, keyRange, "Lock-Free List (hazard pointers)");
+                testContention<EpochReclaimer>(threads, keyRange, "Lock-Free List (epochs)");
+            }
+        }
+        return 0;
+    }
+
+    if (mode == "inline") {
+        std::cout << "Comparing payload lookups through void* and inline values..." << std::endl;
+        testPayloadLookup(numThreads);
+        return 0;
+    }
+
+    if (mode == "skiplist") {
+        LockBasedLinkedList<> boundaryLockBased;
+        IntLinkedList<EpochReclaimer> boundaryList;
+        SkipList<> boundarySkipList;
+        if (!checkBoundaryKeys(boundaryLockBased, "Lock-Based List") ||
+            !checkBoundaryKeys(boundaryList, "Lock-Free List (epochs)") ||
+            !checkBoundaryKeys(boundarySkipList, "Lock-Free Skip List")) {
+            return 1;
+        }
+
+        std::cout << "Comparing lists with the skip list on a search-heavy mix..." << std::endl;
+        for (int keyRange : {2000, 20000}) {
+            std::cout << "Key range " << keyRange << ":" << std::endl;
+            LockBasedLinkedList<> lockBasedList;
+            testSearchHeavy(lockBasedList, numThreads, "Lock-Based List", keyRange);
+            IntLinkedList<EpochReclaimer> epochList;
+            testSearchHeavy(epochList, numThreads, "Lock-Free List (epochs)", keyRange);
+            SkipList<> skipList;
+            testSearchHeavy(skipList, numThreads, "Lock-Free Skip List", keyRange);
+        }
+        return 0;
+    }
+
     std::cout << "Testing Linked List Performance..." << std::endl;
     // Lock-Based Test
-    LockBasedLinkedList lockBasedList;
-    testLockBasedList(lockBasedList, numThreads);
+    LockBasedLinkedList<> lockBasedList;
+    testList(lockBasedList, numThreads, "Lock-Based List");
     
-    // Lock-Free Test
-    LinkedList lockFreeList;
-    testLockFreeList(lockFreeList, numThreads);
+    // Lock-Free Test (shared_ptr reference counting)
+    SharedPtrLinkedList sharedPtrList;
+    testList(sharedPtrList, numThreads, "Lock-Free List (shared_ptr)");
+
+    // Lock-Free Test (hazard pointers)
+    IntLinkedList<HazardPointers> lockFreeList;
+    testList(lockFreeList, numThreads, "Lock-Free List (hazard pointers)");
+
+    // Lock-Free Test (epoch-based reclamation)
+    IntLinkedList<EpochReclaimer> epochList;
+    testList(epochList, numThreads, "Lock-Free List (epochs)");
+
+    // Lock-Free Skip List
+    SkipList<> skipList;
+    testList(skipList, numThreads, "Lock-Free Skip List");
 
     return 0;
 }
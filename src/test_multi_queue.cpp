@@ -0,0 +1,176 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <queue>
+#include <mutex>
+#include <random>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include "../include/MultiQueue.hpp"
+
+
+// Baseline: a strict global min-heap behind one mutex.
+class MutexPriorityQueue {
+public:
+    void Push(uint64_t key, uint64_t value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        heap.emplace(key, value);
+    }
+
+    bool TryPop(uint64_t& key, uint64_t& value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (heap.empty()) {
+            return false;
+        }
+        key = heap.top().first;
+        value = heap.top().second;
+        heap.pop();
+        return true;
+    }
+
+private:
+    using Element = std::pair<uint64_t, uint64_t>;
+    std::priority_queue<Element, std::vector<Element>, std::greater<Element>> heap;
+    std::mutex mutex;
+};
+
+// Fenwick tree over key positions, used to count how many still-queued keys
+// are smaller than a popped one.
+class RankCounter {
+public:
+    explicit RankCounter(size_t n) : tree(n + 1, 0) {}
+
+    void Add(size_t position, int delta) {
+        for (++position; position < tree.size(); position += position & (~position + 1)) {
+            tree[position] += delta;
+        }
+    }
+
+    long Prefix(size_t position) const {
+        long sum = 0;
+        for (; position > 0; position -= position & (~position + 1)) {
+            sum += tree[position];
+        }
+        return sum;
+    }
+
+private:
+    std::vector<long> tree;
+};
+
+// Mixed throughput: every thread alternates Push and TryPop on a prefilled
+// queue with random 64-bit keys.
+template <typename QueueType>
+void testThroughput(QueueType& queue, int numThreads, const std::string& name) {
+    const int opsPerThread = 100000;
+    const int prefill = 10000;
+
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < prefill; ++i) {
+        queue.Push(rng(), 0);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.push_back(std::thread([&queue, i]() {
+            std::mt19937_64 local(static_cast<uint64_t>(i) + 1U);
+            uint64_t key;
+            uint64_t value;
+            for (int j = 0; j < opsPerThread; ++j) {
+                if (j & 1) {
+                    queue.TryPop(key, value);
+                } else {
+                    queue.Push(local(), 0);
+                }
+            }
+        }));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    const double totalOps = static_cast<double>(numThreads) * opsPerThread;
+    std::cout << name << " (" << numThreads << " threads): " << totalOps / duration.count()
+              << " ops/sec.\n";
+}
+
+// Rank error: the threads drain a prefilled queue concurrently, stamping every
+// pop with a global sequence number. Replaying the pops in that order, the rank
+// error of a pop is the number of smaller keys still queued at that moment.
+template <typename QueueType>
+void testRankError(QueueType& queue, int numThreads, const std::string& name) {
+    const size_t count = 100000;
+
+    std::vector<uint64_t> keys(count);
+    for (size_t i = 0; i < count; ++i) {
+        keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64(7));
+    for (uint64_t key : keys) {
+        queue.Push(key, 0);
+    }
+
+    std::vector<uint64_t> order(count);
+    std::atomic<size_t> sequence{0};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.push_back(std::thread([&]() {
+            uint64_t key;
+            uint64_t value;
+            while (queue.TryPop(key, value)) {
+                order[sequence.fetch_add(1)] = key;
+            }
+        }));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    RankCounter queued(count);
+    for (size_t i = 0; i < count; ++i) {
+        queued.Add(i, 1);
+    }
+    double total = 0;
+    long worst = 0;
+    const size_t popped = sequence.load();
+    for (size_t i = 0; i < popped; ++i) {
+        const long rank = queued.Prefix(order[i]);
+        total += rank;
+        worst = std::max(worst, rank);
+        queued.Add(order[i], -1);
+    }
+    std::cout << name << " (" << numThreads << " threads): mean rank error "
+              << total / static_cast<double>(popped) << ", max " << worst << ".\n";
+}
+
+int main() {
+    std::cout << "Testing relaxed priority queue throughput..." << std::endl;
+    for (int numThreads : {1, 2, 4, 8}) {
+        MutexPriorityQueue mutexQueue;
+        testThroughput(mutexQueue, numThreads, "Mutex std::priority_queue");
+        for (size_t c : {1U, 2U, 4U}) {
+            MultiQueue<uint64_t, uint64_t> multiQueue(numThreads, c);
+            testThroughput(multiQueue, numThreads, "MultiQueue c=" + std::to_string(c));
+        }
+    }
+
+    std::cout << "Measuring rank error..." << std::endl;
+    for (int numThreads : {1, 4, 8}) {
+        MutexPriorityQueue mutexQueue;
+        testRankError(mutexQueue, numThreads, "Mutex std::priority_queue");
+        for (size_t c : {1U, 2U, 4U}) {
+            MultiQueue<uint64_t, uint64_t> multiQueue(numThreads, c);
+            testRankError(multiQueue, numThreads, "MultiQueue c=" + std::to_string(c));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "../include/NumaQueue.hpp"
+#include "../include/Platform.hpp"
+
+const size_t CAPACITY = 1024;
+const uint64_t ITEMS = uint64_t(1) << 19; // Items per producer, and per consumer
+
+// Starts threadsPerNode producers and as many consumers on every node, each
+// pinned to a CPU of its node, and moves ITEMS per producer through queue.
+// Returns the sum of everything popped.
+template <typename QueueType>
+uint64_t runPinned(QueueType& queue, size_t threadsPerNode) {
+    const NumaTopology& topology = NumaTopology::Get();
+    std::atomic<uint64_t> total{0};
+    std::vector<std::thread> threads;
+
+    for (size_t node = 0; node < topology.NodeCount(); ++node) {
+        const std::vector<size_t>& cpus = topology.Cpus(node);
+        for (size_t i = 0; i < threadsPerNode; ++i) {
+            const size_t producerCpu = cpus[(2 * i) % cpus.size()];
+            const size_t consumerCpu = cpus[(2 * i + 1) % cpus.size()];
+
+            threads.emplace_back([&queue, producerCpu]() {
+                PinCurrentThread(producerCpu);
+                for (uint64_t j = 0; j < ITEMS; ++j) {
+                    while (!queue.Push(j)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+            threads.emplace_back([&queue, &total, consumerCpu]() {
+                PinCurrentThread(consumerCpu);
+                uint64_t sum = 0;
+                uint64_t value;
+                for (uint64_t j = 0; j < ITEMS; ++j) {
+                    while (!queue.Pop(value)) {
+                        std::this_thread::yield();
+                    }
+                    sum += value;
+                }
+                total.fetch_add(sum);
+            });
+        }
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return total.load();
+}
+
+template <typename Func>
+void measure(Func f, const std::string& name, size_t threadsPerNode, uint64_t expected) {
+    auto start = std::chrono::high_resolution_clock::now();
+    const uint64_t result = f();
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    std::cout << name << " (" << threadsPerNode << "+" << threadsPerNode << " threads per node): "
+              << duration.count() << " ms" << (result == expected ? "" : " WRONG RESULT") << std::endl;
+}
+
+int main() {
+    const NumaTopology& topology = NumaTopology::Get();
+    std::cout << "NUMA nodes: " << topology.NodeCount() << std::endl;
+    for (size_t node = 0; node < topology.NodeCount(); ++node) {
+        std::cout << "  node " << topology.NodeId(node) << ": " << topology.Cpus(node).size() << " CPUs"
+                  << std::endl;
+    }
+
+    std::cout << "Comparing one shared Queue with a NUMA-sharded queue, threads pinned per node..." << std::endl;
+    for (size_t threadsPerNode : {1, 2, 4}) {
+        const uint64_t producers = threadsPerNode * topology.NodeCount();
+        const uint64_t expected = producers * (ITEMS * (ITEMS - 1) / 2);
+
+        auto shared = std::make_unique<Queue<uint64_t, CAPACITY>>();
+        measure([&] { return runPinned(*shared, threadsPerNode); }, "Shared Queue", threadsPerNode, expected);
+
+        NumaQueue<uint64_t, CAPACITY> sharded;
+        measure([&] { return runPinned(sharded, threadsPerNode); },
+                "NumaQueue (" + std::to_string(sharded.ShardCount()) + " shards)", threadsPerNode, expected);
+    }
+
+    return 0;
+}
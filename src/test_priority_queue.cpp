@@ -5,7 +5,12 @@
 #include <chrono>
 #include <queue>
 #include <mutex>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
 #include "../include/Priority_Queue.hpp" // Include your lock-free priority queue
+#include "../include/BlockingQueue.hpp"
 
 const int NUM_PRODUCERS = 4;
 const int NUM_CONSUMERS = 4;
@@ -72,6 +77,163 @@ void lockfree_priority_consumer(PriorityQueue<int, 10, PRIORITY_COUNT>& queue) {
 }
 
 
+void blocking_priority_producer(BlockingPriorityQueue<int, 10, PRIORITY_COUNT>& queue, int priority) {
+    for (int i = 0; i < NUM_ITEMS; ++i) {
+        queue.PushWait(i, static_cast<size_t>(priority));
+    }
+}
+
+void blocking_priority_consumer(BlockingPriorityQueue<int, 10, PRIORITY_COUNT>& queue) {
+    int value;
+    while (queue.PopWait(value)) {
+    }
+}
+
+
+// The previous PriorityQueue::Pop, which probes every level from the top.
+// Kept as a baseline for the level sweep.
+template <typename T, size_t size, size_t priority_count>
+class LinearScanPriorityQueue {
+  public:
+    bool Push(const T &element, size_t priority) { return _subqueue[priority].Push(element); }
+
+    bool Pop(T &element) {
+        for (size_t priority = priority_count; priority-- > 0;) {
+            if (_subqueue[priority].Pop(element)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+  private:
+    Queue<T, size> _subqueue[priority_count];
+};
+
+// Worst case for a scanning Pop: all work sits on the lowest level. Runs
+// push/pop batches on one thread so the cost of locating the level is not
+// hidden behind scheduling.
+template <typename QueueType>
+double time_lowest_level(QueueType& queue, int items) {
+    const int batch = 32;
+    int value;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < items; i += batch) {
+        for (int j = 0; j < batch; ++j) {
+            queue.Push(i + j, 0);
+        }
+        for (int j = 0; j < batch; ++j) {
+            queue.Pop(value);
+        }
+        queue.Pop(value); // Empty probe
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    return duration.count() * 1e9 / items;
+}
+
+template <size_t priority_count>
+void sweep_priority_levels() {
+    const int items = 320000;
+    auto scanning = std::make_unique<LinearScanPriorityQueue<int, 64, priority_count>>();
+    auto bitmap = std::make_unique<PriorityQueue<int, 64, priority_count>>();
+    std::cout << priority_count << " levels: linear scan " << time_lowest_level(*scanning, items)
+              << " ns/item, bitmap " << time_lowest_level(*bitmap, items) << " ns/item" << std::endl;
+}
+
+// Consumers that work in batches of 64: refill every level, then drain the
+// whole queue either one Pop at a time or with PopBatch.
+template <size_t priority_count>
+void compare_batch_drain() {
+    const int rounds = 2000;
+    const size_t batch = 64;
+    const size_t per_level = 512 / priority_count;
+    auto queue = std::make_unique<PriorityQueue<int, 64, priority_count>>();
+    int out[batch];
+
+    auto fill = [&] {
+        for (size_t priority = 0; priority < priority_count; ++priority) {
+            for (size_t i = 0; i < per_level; ++i) {
+                queue->Push(static_cast<int>(i), priority);
+            }
+        }
+    };
+    auto time_drain = [&](auto drain) {
+        std::chrono::duration<double> total{0};
+        size_t items = 0;
+        for (int round = 0; round < rounds; ++round) {
+            fill();
+            auto start = std::chrono::high_resolution_clock::now();
+            items += drain();
+            total += std::chrono::high_resolution_clock::now() - start;
+        }
+        return total.count() * 1e9 / static_cast<double>(items);
+    };
+
+    const double single = time_drain([&] {
+        size_t items = 0;
+        while (queue->Pop(out[items % batch])) {
+            ++items;
+        }
+        return items;
+    });
+    const double batched = time_drain([&] {
+        size_t items = 0;
+        size_t popped;
+        while ((popped = queue->PopBatch(out, batch)) > 0) {
+            items += popped;
+        }
+        return items;
+    });
+    std::cout << priority_count << " levels x " << per_level << " items: Pop " << single
+              << " ns/item, PopBatch(" << batch << ") " << batched << " ns/item" << std::endl;
+}
+
+// Wait time per level under overload: every tick offers one element to each
+// level but pops only two, so the queue stays saturated and the schedule alone
+// decides who waits. Runs on one thread so the result does not depend on how
+// the OS interleaves producers and consumers. Each element carries its push
+// time (in the upper bits) and level (in the low bits).
+template <typename QueueType>
+void measure_level_waits(const std::string& name) {
+    const int ticks = 200000;
+    const int pops_per_tick = 2;
+    auto queue = std::make_unique<QueueType>();
+    const auto origin = std::chrono::steady_clock::now();
+    auto now_ns = [origin] {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now() - origin)
+                                         .count());
+    };
+
+    std::vector<std::vector<uint64_t>> waits(PRIORITY_COUNT);
+    for (int tick = 0; tick < ticks; ++tick) {
+        for (int priority = 0; priority < PRIORITY_COUNT; ++priority) {
+            queue->Push(now_ns() << 4 | static_cast<uint64_t>(priority), static_cast<size_t>(priority));
+        }
+        uint64_t stamp;
+        for (int i = 0; i < pops_per_tick && queue->Pop(stamp); ++i) {
+            waits[stamp & 15U].push_back(now_ns() - (stamp >> 4));
+        }
+    }
+
+    std::cout << name << ":" << std::endl;
+    for (int priority = PRIORITY_COUNT - 1; priority >= 0; --priority) {
+        std::vector<uint64_t>& level = waits[priority];
+        std::cout << "  level " << priority << ": ";
+        if (level.empty()) {
+            std::cout << "starved (0 pops)" << std::endl;
+            continue;
+        }
+        std::sort(level.begin(), level.end());
+        auto percentile = [&level](double p) {
+            return static_cast<double>(level[static_cast<size_t>(p * static_cast<double>(level.size() - 1U))]) / 1e3;
+        };
+        std::cout << level.size() << " pops, wait p50 " << percentile(0.5) << " us, p99 "
+                  << percentile(0.99) << " us, p999 " << percentile(0.999) << " us" << std::endl;
+    }
+}
+
 template <typename Func>
 void measure_performance(Func f, const std::string& name) {
     auto start = std::chrono::high_resolution_clock::now();
@@ -81,7 +243,35 @@ void measure_performance(Func f, const std::string& name) {
     std::cout << name << " took " << duration.count() << " seconds." << std::endl;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    const std::string mode = argc > 1 ? argv[1] : "default";
+
+    if (mode == "levels") {
+        std::cout << "Sweeping priority levels (all work on the lowest level)..." << std::endl;
+        sweep_priority_levels<4>();
+        sweep_priority_levels<16>();
+        sweep_priority_levels<64>();
+        sweep_priority_levels<256>();
+        sweep_priority_levels<1024>();
+        sweep_priority_levels<4096>();
+        return 0;
+    }
+    if (mode == "batch") {
+        std::cout << "Draining 512 queued items per round..." << std::endl;
+        compare_batch_drain<8>();
+        compare_batch_drain<64>();
+        compare_batch_drain<512>();
+        return 0;
+    }
+    if (mode == "fairness") {
+        std::cout << "Measuring wait time per level under overload (4 offered, 2 popped per tick)..." << std::endl;
+        measure_level_waits<PriorityQueue<uint64_t, 64, PRIORITY_COUNT>>("Strict priority");
+        measure_level_waits<PriorityQueue<uint64_t, 64, PRIORITY_COUNT, WeightedFair<>>>(
+            "Weighted fair (shares 1:2:3:4)");
+        measure_level_waits<PriorityQueue<uint64_t, 64, PRIORITY_COUNT, WeightedFair<1>>>(
+            "Weighted fair, top level bypassing");
+        return 0;
+    }
     
     std::cout << "Measuring standard priority queue performance..." << std::endl;
     measure_performance([] {
@@ -132,5 +322,29 @@ int main() {
 
     }, "Lock-Free Priority Queue");
 
+    std::cout << "Measuring blocking priority queue performance..." << std::endl;
+    BlockingPriorityQueue<int, 10, PRIORITY_COUNT> blocking_priority_queue;
+    measure_performance([&] {
+        std::vector<std::thread> producers, consumers;
+
+        for (int priority = 0; priority < PRIORITY_COUNT; ++priority) {
+            for (int i = 0; i < NUM_PRODUCERS / PRIORITY_COUNT; ++i) {
+                producers.emplace_back(blocking_priority_producer, std::ref(blocking_priority_queue), priority);
+            }
+        }
+        for (int i = 0; i < NUM_CONSUMERS; ++i) {
+            consumers.emplace_back(blocking_priority_consumer, std::ref(blocking_priority_queue));
+        }
+
+        for (auto& p : producers) {
+            p.join();
+        }
+        blocking_priority_queue.Close();
+        for (auto& c : consumers) {
+            c.join();
+        }
+
+    }, "Blocking Priority Queue");
+
     return 0;
 }
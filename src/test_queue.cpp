@@ -5,16 +5,27 @@
 #include <chrono>
 #include <queue>
 #include <mutex>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <type_traits>
 #include "../include/Queue.hpp" // Include your lock-free queue
+#include "../include/BlockingQueue.hpp"
 
 const int NUM_PRODUCERS = 4;
 const int NUM_CONSUMERS = 4;
 const int NUM_ITEMS = 10000000; // Total items produced by each producer
+const int BULK_SIZE = 64;        // Batch size for the PushBulk/PopBulk run
+const int STATS_ITEMS = 100000;  // Items per producer in the contention run
+const int STRING_ITEMS = 100000; // Items per producer in the string run
 
 // Mutex-protected queue for comparison
 std::queue<int> std_queue;
 std::mutex queue_mutex;
 
+// Sum of every value popped in the PushBulk/PopBulk run
+std::atomic<long long> bulk_checksum{0};
+
 void std_producer() {
     for (int i = 0; i < NUM_ITEMS; ++i) {
         std::lock_guard<std::mutex> lock(queue_mutex);
@@ -38,13 +49,15 @@ void std_consumer() {
     }
 }
 
-void lockfree_producer(Queue<int, 10>& queue) {
+template <typename QueueType>
+void lockfree_producer(QueueType& queue) {
     for (int i = 0; i < NUM_ITEMS; ++i) {
         while (!queue.Push(i)) {}
     }
 }
 
-void lockfree_consumer(Queue<int, 10>& queue) {
+template <typename QueueType>
+void lockfree_consumer(QueueType& queue) {
     for (int i = 0; i < NUM_ITEMS; ++i) {
         int value;
         while (!queue.Pop(value)) {}
@@ -52,6 +65,51 @@ void lockfree_consumer(Queue<int, 10>& queue) {
     }
 }
 
+template <typename QueueType>
+void lockfree_bulk_producer(QueueType& queue) {
+    int batch[BULK_SIZE];
+    for (int i = 0; i < NUM_ITEMS; i += BULK_SIZE) {
+        const int count = std::min(BULK_SIZE, NUM_ITEMS - i);
+        for (int j = 0; j < count; ++j) {
+            batch[j] = i + j;
+        }
+        size_t pushed = 0;
+        while (pushed < static_cast<size_t>(count)) {
+            pushed += queue.PushBulk(batch + pushed, count - pushed);
+        }
+    }
+}
+
+template <typename QueueType>
+void lockfree_bulk_consumer(QueueType& queue) {
+    int batch[BULK_SIZE];
+    int consumed = 0;
+    long long sum = 0;
+    while (consumed < NUM_ITEMS) {
+        const int wanted = std::min(BULK_SIZE, NUM_ITEMS - consumed);
+        const int popped = static_cast<int>(queue.PopBulk(batch, wanted));
+        for (int j = 0; j < popped; ++j) {
+            sum += batch[j];
+        }
+        consumed += popped;
+    }
+    bulk_checksum.fetch_add(sum);
+}
+
+template <typename QueueType>
+void blocking_producer(QueueType& queue) {
+    for (int i = 0; i < NUM_ITEMS; ++i) {
+        queue.PushWait(i);
+    }
+}
+
+template <typename QueueType>
+void blocking_consumer(QueueType& queue) {
+    int value;
+    while (queue.PopWait(value)) {
+    }
+}
+
 template <typename Func>
 void measure_performance(Func f, const std::string& name) {
     auto start = std::chrono::high_resolution_clock::now();
@@ -61,7 +119,150 @@ void measure_performance(Func f, const std::string& name) {
     std::cout << name << " took " << duration.count() << " seconds." << std::endl;
 }
 
-int main() {
+template <typename QueueType, typename Producer, typename Consumer>
+void measure_lockfree_queue(QueueType& queue, const std::string& name,
+                            Producer producer, Consumer consumer) {
+    measure_performance([&] {
+        std::vector<std::thread> producers, consumers;
+
+        for (int i = 0; i < NUM_PRODUCERS; ++i) {
+            producers.emplace_back(producer, std::ref(queue));
+        }
+        for (int i = 0; i < NUM_CONSUMERS; ++i) {
+            consumers.emplace_back(consumer, std::ref(queue));
+        }
+
+        for (auto& p : producers) {
+            p.join();
+        }
+        for (auto& c : consumers) {
+            c.join();
+        }
+    }, name);
+}
+
+// Runs threads producers against threads consumers on a queue that counts
+// contention, and prints where its Push and Pop calls went round again.
+template <size_t Capacity>
+void report_contention(int threads) {
+    using StatsQueue = Queue<int, Capacity, CompactLayout, ContentionStats>;
+    auto queue = std::make_unique<StatsQueue>();
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&queue] {
+            for (int j = 0; j < STATS_ITEMS; ++j) {
+                while (!queue->Push(j)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        workers.emplace_back([&queue] {
+            int value;
+            for (int j = 0; j < STATS_ITEMS; ++j) {
+                while (!queue->Pop(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    const StatsSnapshot stats = queue->Stats();
+    std::cout << "capacity " << Capacity << ", " << threads << "x" << threads << " threads: "
+              << stats.operations << " calls, " << stats.full_rejections << " full, "
+              << stats.empty_rejections << " empty, " << stats.cas_failures << " CAS failures, "
+              << stats.turn_waits << " turn waits, " << stats.RetriesPerOperation()
+              << " retries/call" << std::endl;
+}
+
+// Moves STRING_ITEMS strings per producer through queue, either stored in
+// the slots or boxed on the heap behind a pointer, and returns the total
+// length popped.
+template <typename QueueType>
+size_t run_strings(QueueType& queue) {
+    using Element = typename decltype(queue.PopOptional())::value_type;
+    constexpr bool boxed = std::is_pointer<Element>::value;
+    std::atomic<size_t> total{0};
+    std::vector<std::thread> workers;
+    for (int i = 0; i < NUM_PRODUCERS; ++i) {
+        workers.emplace_back([&queue] {
+            for (int j = 0; j < STRING_ITEMS; ++j) {
+                // Long enough to defeat the small-string buffer
+                std::string value = "element number " + std::to_string(j) + " of the string run";
+                if constexpr (boxed) {
+                    std::string* box = new std::string(std::move(value));
+                    while (!queue.Push(box)) {
+                        std::this_thread::yield();
+                    }
+                } else {
+                    while (!queue.Push(std::move(value))) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        });
+        workers.emplace_back([&queue, &total] {
+            size_t length = 0;
+            for (int j = 0; j < STRING_ITEMS; ++j) {
+                auto value = queue.PopOptional();
+                while (!value) {
+                    std::this_thread::yield();
+                    value = queue.PopOptional();
+                }
+                if constexpr (boxed) {
+                    length += (*value)->size();
+                    delete *value;
+                } else {
+                    length += value->size();
+                }
+            }
+            total.fetch_add(length);
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    return total.load();
+}
+
+int main(int argc, char* argv[]) {
+    const std::string mode = argc > 1 ? argv[1] : "default";
+
+    if (mode == "stats") {
+        std::cout << "Measuring lock-free queue contention..." << std::endl;
+        for (int threads : {1, 2, 4}) {
+            report_contention<10>(threads);
+            report_contention<1024>(threads);
+        }
+        return 0;
+    }
+
+    if (mode == "strings") {
+        std::cout << "Measuring lock-free queue with std::string elements..." << std::endl;
+        auto inline_queue = std::make_unique<Queue<std::string, 1024>>();
+        size_t inline_total = 0;
+        measure_performance([&] { inline_total = run_strings(*inline_queue); },
+                            "Lock-Free Queue (std::string in place)");
+
+        auto boxed_queue = std::make_unique<Queue<std::string*, 1024>>();
+        size_t boxed_total = 0;
+        measure_performance([&] { boxed_total = run_strings(*boxed_queue); },
+                            "Lock-Free Queue (boxed std::string*)");
+        if (inline_total != boxed_total) {
+            std::cout << "WRONG RESULT: " << inline_total << " != " << boxed_total << std::endl;
+            return 1;
+        }
+
+        // Elements still queued are destroyed with the queue
+        inline_queue->Emplace(64, 'x');
+        inline_queue->Push(std::string(64, 'y'));
+        inline_queue.reset();
+        return 0;
+    }
+
     // Measure performance for standard queue
     std::cout << "Measuring standard queue performance..." << std::endl;
     measure_performance([] {
@@ -82,26 +283,65 @@ int main() {
         }
     }, "Standard Queue");
 
-    // Measure performance for lock-free queue
+    // Measure performance for lock-free queue with both slot layouts
     std::cout << "Measuring lock-free queue performance..." << std::endl;
-    Queue<int, 10> lockfree_queue;
+    using CompactQueue = Queue<int, 10, CompactLayout>;
+    using PaddedQueue = Queue<int, 10, PaddedLayout>;
+
+    CompactQueue lockfree_queue;
+    measure_lockfree_queue(lockfree_queue, "Lock-Free Queue (compact layout)",
+                           lockfree_producer<CompactQueue>,
+                           lockfree_consumer<CompactQueue>);
+
+    PaddedQueue padded_queue;
+    measure_lockfree_queue(padded_queue, "Lock-Free Queue (padded layout)",
+                           lockfree_producer<PaddedQueue>,
+                           lockfree_consumer<PaddedQueue>);
+
+    // Single Push/Pop against PushBulk/PopBulk on a queue large enough to
+    // hold several batches
+    std::cout << "Measuring lock-free bulk queue performance..." << std::endl;
+    using BulkQueue = Queue<int, 1024>;
+
+    auto single_queue = std::make_unique<BulkQueue>();
+    measure_lockfree_queue(*single_queue, "Lock-Free Queue (single Push/Pop)",
+                           lockfree_producer<BulkQueue>,
+                           lockfree_consumer<BulkQueue>);
+
+    auto bulk_queue = std::make_unique<BulkQueue>();
+    measure_lockfree_queue(*bulk_queue, "Lock-Free Queue (PushBulk/PopBulk)",
+                           lockfree_bulk_producer<BulkQueue>,
+                           lockfree_bulk_consumer<BulkQueue>);
+    const long long expected_bulk = static_cast<long long>(NUM_PRODUCERS) * NUM_ITEMS * (NUM_ITEMS - 1) / 2;
+    if (bulk_checksum.load() != expected_bulk) {
+        std::cout << "WRONG RESULT: PopBulk checksum " << bulk_checksum.load() << " != " << expected_bulk
+                  << std::endl;
+        return 1;
+    }
+
+    // Blocking adapter: consumers park instead of spinning and stop when the
+    // queue is closed and drained
+    std::cout << "Measuring blocking queue performance..." << std::endl;
+    using Blocking = BlockingQueue<int, 10>;
+    Blocking blocking_queue;
     measure_performance([&] {
         std::vector<std::thread> producers, consumers;
 
         for (int i = 0; i < NUM_PRODUCERS; ++i) {
-            producers.emplace_back(lockfree_producer, std::ref(lockfree_queue));
+            producers.emplace_back(blocking_producer<Blocking>, std::ref(blocking_queue));
         }
         for (int i = 0; i < NUM_CONSUMERS; ++i) {
-            consumers.emplace_back(lockfree_consumer, std::ref(lockfree_queue));
+            consumers.emplace_back(blocking_consumer<Blocking>, std::ref(blocking_queue));
         }
 
         for (auto& p : producers) {
             p.join();
         }
+        blocking_queue.Close();
         for (auto& c : consumers) {
             c.join();
         }
-    }, "Lock-Free Queue");
+    }, "Blocking Queue");
 
     return 0;
 }
@@ -4,37 +4,186 @@
 #include <vector>
 #include <atomic>
 #include <chrono>
+#include <algorithm>
 #include "../include/RingBuffer.hpp"
+#include "../include/MirroredRingBuffer.hpp"
 // Include the RingBuf code you provided here.
 
-void testLockFreeBuffer() {
+void testSpscBuffer() {
+    constexpr size_t buffer_size = 1024;
+    constexpr int items = 10000000;
+
+    RingBuf<int, buffer_size> buffer;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::thread producer([&]() {
+        for (int i = 0; i < items; ++i) {
+            while (!buffer.Write(&i, 1)) {
+            }
+        }
+    });
+    std::thread consumer([&]() {
+        int value;
+        for (int i = 0; i < items; ++i) {
+            while (!buffer.Read(&value, 1)) {
+            }
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end_time - start_time;
+
+    std::cout << "Lock-Free SPSC Ring Buffer:" << std::endl;
+    std::cout << "Elapsed Time: " << elapsed.count() << " seconds\n" << std::endl;
+}
+
+// Returns false if the consumer's checksum is wrong.
+bool testZeroCopyBuffer() {
+    constexpr size_t buffer_size = 1024;
+    constexpr size_t batch = 64;
+    constexpr int items = 10000000;
+
+    RingBuf<int, buffer_size> buffer;
+    std::atomic<long long> checksum{0};
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::thread producer([&]() {
+        int next = 0;
+        while (next < items) {
+            auto region = buffer.WriteReserve(batch);
+            size_t n = 0;
+            for (int& slot : region.first) {
+                slot = next + static_cast<int>(n++);
+            }
+            for (int& slot : region.second) {
+                slot = next + static_cast<int>(n++);
+            }
+            n = std::min(n, static_cast<size_t>(items - next));
+            buffer.WriteCommit(n);
+            next += static_cast<int>(n);
+        }
+    });
+    std::thread consumer([&]() {
+        long long sum = 0;
+        int consumed = 0;
+        while (consumed < items) {
+            auto region = buffer.ReadAcquire(batch);
+            for (int value : region.first) {
+                sum += value;
+            }
+            for (int value : region.second) {
+                sum += value;
+            }
+            buffer.ReadRelease(region.size());
+            consumed += static_cast<int>(region.size());
+        }
+        checksum.store(sum);
+    });
+
+    producer.join();
+    consumer.join();
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end_time - start_time;
+
+    const long long expected = static_cast<long long>(items) * (items - 1) / 2;
+    const bool ok = checksum.load() == expected;
+
+    std::cout << "Lock-Free SPSC Ring Buffer (zero-copy):" << (ok ? "" : " WRONG RESULT") << std::endl;
+    std::cout << "Elapsed Time: " << elapsed.count() << " seconds\n" << std::endl;
+    return ok;
+}
+
+#if defined(__linux__)
+// Returns false if the consumer's checksum is wrong.
+bool testMirroredBuffer() {
+    constexpr size_t batch = 64;
+    constexpr int items = 10000000;
+
+    MirroredRingBuf<int> buffer(1024);
+    std::atomic<long long> checksum{0};
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::thread producer([&]() {
+        int next = 0;
+        while (next < items) {
+            auto span = buffer.WriteReserve(batch);
+            const size_t n = std::min(span.size(), static_cast<size_t>(items - next));
+            for (size_t i = 0; i < n; ++i) {
+                span[i] = next + static_cast<int>(i);
+            }
+            buffer.WriteCommit(n);
+            next += static_cast<int>(n);
+        }
+    });
+    std::thread consumer([&]() {
+        long long sum = 0;
+        int consumed = 0;
+        while (consumed < items) {
+            auto span = buffer.ReadAcquire(batch);
+            for (int value : span) {
+                sum += value;
+            }
+            buffer.ReadRelease(span.size());
+            consumed += static_cast<int>(span.size());
+        }
+        checksum.store(sum);
+    });
+
+    producer.join();
+    consumer.join();
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end_time - start_time;
+
+    const long long expected = static_cast<long long>(items) * (items - 1) / 2;
+    const bool ok = checksum.load() == expected;
+
+    std::cout << "Lock-Free SPSC Ring Buffer (mirrored, zero-copy):" << (ok ? "" : " WRONG RESULT") << std::endl;
+    std::cout << "Elapsed Time: " << elapsed.count() << " seconds\n" << std::endl;
+    return ok;
+}
+#endif
+
+// Returns false if an item was lost or duplicated.
+bool testLockFreeBuffer() {
     constexpr size_t buffer_size = 1024;
     constexpr size_t num_producers = 4;
     constexpr size_t num_consumers = 4;
-    constexpr size_t items_per_producer = 10000000;
+    constexpr int items_per_producer = 10000000;
 
-    RingBuf<int, buffer_size> buffer;
+    MpmcRingBuf<int, buffer_size> buffer;
     std::atomic<size_t> items_produced{0}, items_consumed{0};
     std::atomic<bool> producers_done{false};
+    std::atomic<long long> checksum{0};
 
     auto producer = [&]() {
-    for (int i = 0; i < items_per_producer; ++i) {
-        while (!buffer.Write(&i, 1)) {
+        for (int i = 0; i < items_per_producer; ++i) {
+            while (!buffer.Write(&i, 1)) {
+            }
+            ++items_produced;
         }
-        ++items_produced;
-    }
-};
+    };
 
 
     auto consumer = [&]() {
         int value;
+        long long sum = 0;
         while (true) {
             if (buffer.Read(&value, 1)) {
+                sum += value;
                 ++items_consumed;
             } else if (producers_done.load()) {
                 break;
             }
         }
+        checksum.fetch_add(sum);
     };
 
     auto start_time = std::chrono::high_resolution_clock::now();
@@ -60,8 +209,13 @@ void testLockFreeBuffer() {
     auto end_time = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed = end_time - start_time;
 
-    std::cout << "Lock-Free Ring Buffer:" << std::endl;
+    const long long expected =
+        static_cast<long long>(num_producers) * items_per_producer * (items_per_producer - 1) / 2;
+    const bool ok = items_consumed.load() == num_producers * items_per_producer && checksum.load() == expected;
+
+    std::cout << "Lock-Free MPMC Ring Buffer:" << (ok ? "" : " WRONG RESULT") << std::endl;
     std::cout << "Elapsed Time: " << elapsed.count() << " seconds\n" << std::endl;
+    return ok;
 }
 
 void testLockBasedBuffer() {
@@ -125,9 +279,19 @@ int main() {
     std::cout << "Testing Lock-Based Ring Buffer...\n";
     testLockBasedBuffer();
 
-    std::cout << "Testing Lock-Free Ring Buffer...\n";
-    testLockFreeBuffer();
+    std::cout << "Testing Lock-Free MPMC Ring Buffer...\n";
+    bool ok = testLockFreeBuffer();
+
+    std::cout << "Testing Lock-Free SPSC Ring Buffer...\n";
+    testSpscBuffer();
+
+    std::cout << "Testing Lock-Free SPSC Ring Buffer (zero-copy)...\n";
+    ok = testZeroCopyBuffer() && ok;
 
+#if defined(__linux__)
+    std::cout << "Testing Lock-Free SPSC Ring Buffer (mirrored)...\n";
+    ok = testMirroredBuffer() && ok;
+#endif
 
-    return 0;
+    return ok ? 0 : 1;
 }
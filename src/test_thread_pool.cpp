@@ -0,0 +1,238 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+#include "../include/ThreadPool.hpp"
+
+
+// Baseline: every task, local or not, goes through one shared Queue, so all
+// spawns and pops contend on its _w_count and _r_count.
+class SharedQueuePool {
+public:
+    explicit SharedQueuePool(size_t threads) : queue(new Queue<Task*, QUEUE_SIZE>()) {
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this]() {
+                while (true) {
+                    if (RunOne()) {
+                        continue;
+                    }
+                    if (stop.load(std::memory_order_acquire)) {
+                        break;
+                    }
+                    std::this_thread::yield();
+                }
+            });
+        }
+    }
+
+    ~SharedQueuePool() {
+        stop.store(true, std::memory_order_release);
+        for (auto& t : workers) {
+            t.join();
+        }
+    }
+
+    template <typename F>
+    void Spawn(F&& function, std::atomic<size_t>* pending) {
+        using Function = std::decay_t<F>;
+        Task* task = PoolAllocator::create<FunctionTask<Function>>(Function(std::forward<F>(function)), pending);
+        if (!queue->Push(task)) {
+            task->execute(task);
+        }
+    }
+
+    bool RunOne() {
+        Task* task;
+        if (!queue->Pop(task)) {
+            return false;
+        }
+        task->execute(task);
+        return true;
+    }
+
+private:
+    static constexpr size_t QUEUE_SIZE = 65536;
+
+    struct Task {
+        void (*execute)(Task*);
+    };
+
+    template <typename F>
+    struct FunctionTask : Task {
+        F function;
+        std::atomic<size_t>* pending;
+
+        FunctionTask(F&& f, std::atomic<size_t>* counter) : Task{&Execute}, function(std::move(f)), pending(counter) {}
+
+        static void Execute(Task* task) {
+            FunctionTask* self = static_cast<FunctionTask*>(task);
+            std::atomic<size_t>* counter = self->pending;
+            self->function();
+            PoolAllocator::destroy(self);
+            counter->fetch_sub(1, std::memory_order_release);
+        }
+    };
+
+    std::unique_ptr<Queue<Task*, QUEUE_SIZE>> queue;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stop{false};
+};
+
+class SharedQueueGroup {
+public:
+    explicit SharedQueueGroup(SharedQueuePool& owner) : pool(owner) {}
+
+    template <typename F>
+    void Run(F&& function) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        pool.Spawn(std::forward<F>(function), &pending);
+    }
+
+    void Wait() {
+        while (pending.load(std::memory_order_acquire) != 0) {
+            if (!pool.RunOne()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    SharedQueuePool& pool;
+    std::atomic<size_t> pending{0};
+};
+
+const int FIB_N = 32;
+const int FIB_CUTOFF = 14;
+const size_t SUM_SIZE = size_t(1) << 22;
+const size_t SUM_GRAIN = size_t(1) << 13;
+
+uint64_t serialFib(int n) {
+    return n < 2 ? static_cast<uint64_t>(n) : serialFib(n - 1) + serialFib(n - 2);
+}
+
+template <typename Pool, typename Group>
+uint64_t fib(Pool& pool, int n) {
+    if (n < FIB_CUTOFF) {
+        return serialFib(n);
+    }
+    uint64_t a = 0;
+    Group group(pool);
+    group.Run([&pool, &a, n]() { a = fib<Pool, Group>(pool, n - 1); });
+    const uint64_t b = fib<Pool, Group>(pool, n - 2);
+    group.Wait();
+    return a + b;
+}
+
+template <typename Pool, typename Group>
+uint64_t parallelSum(Pool& pool, const uint64_t* data, size_t count) {
+    if (count <= SUM_GRAIN) {
+        return std::accumulate(data, data + count, uint64_t(0));
+    }
+    const size_t half = count / 2;
+    uint64_t left = 0;
+    Group group(pool);
+    group.Run([&pool, &left, data, half]() { left = parallelSum<Pool, Group>(pool, data, half); });
+    const uint64_t right = parallelSum<Pool, Group>(pool, data + half, count - half);
+    group.Wait();
+    return left + right;
+}
+
+template <typename Func>
+void measure(Func f, const std::string& name, size_t threads, uint64_t expected) {
+    auto start = std::chrono::high_resolution_clock::now();
+    const uint64_t result = f();
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    std::cout << name << " (" << threads << " threads): " << duration.count() << " ms"
+              << (result == expected ? "" : " WRONG RESULT") << std::endl;
+}
+
+// Throws from submitted and grouped tasks. The pool must survive, keep the
+// Submit exception for Rethrow, and still finish every other task.
+bool checkExceptions(size_t threads) {
+    ThreadPool pool(threads);
+    std::atomic<int> done{0};
+    pool.Submit([] { throw std::runtime_error("submitted"); });
+
+    bool groupCaught = false;
+    TaskGroup group(pool);
+    for (int i = 0; i < 100; ++i) {
+        group.Run([&done, i] {
+            if (i == 50) {
+                throw std::runtime_error("grouped");
+            }
+            done.fetch_add(1);
+        });
+    }
+    try {
+        group.Wait();
+    } catch (const std::runtime_error&) {
+        groupCaught = true;
+    }
+
+    bool submitCaught = false;
+    for (int attempt = 0; attempt < 100000 && !submitCaught; ++attempt) {
+        try {
+            pool.Rethrow();
+            std::this_thread::yield();
+        } catch (const std::runtime_error&) {
+            submitCaught = true;
+        }
+    }
+    const bool ok = groupCaught && submitCaught && done.load() == 99;
+    std::cout << "Task exceptions (" << threads << " threads): " << (ok ? "ok" : "WRONG RESULT") << std::endl;
+    return ok;
+}
+
+int main() {
+    std::vector<uint64_t> data(SUM_SIZE);
+    std::iota(data.begin(), data.end(), uint64_t(0));
+    const uint64_t expectedSum = SUM_SIZE * (SUM_SIZE - 1) / 2;
+    const uint64_t expectedFib = serialFib(FIB_N);
+
+    std::vector<size_t> threadCounts = {1, 2, 4};
+    const size_t cores = std::thread::hardware_concurrency();
+    if (cores > 4) {
+        threadCounts.push_back(cores);
+    }
+
+    for (size_t threads : threadCounts) {
+        if (!checkExceptions(threads)) {
+            return 1;
+        }
+    }
+
+    std::cout << "Fork-join fib(" << FIB_N << "), cutoff " << FIB_CUTOFF << "..." << std::endl;
+    for (size_t threads : threadCounts) {
+        SharedQueuePool shared(threads);
+        measure([&] { return fib<SharedQueuePool, SharedQueueGroup>(shared, FIB_N); },
+                "Shared Queue pool", threads, expectedFib);
+        ThreadPool stealing(threads);
+        measure([&] { return fib<ThreadPool, TaskGroup>(stealing, FIB_N); },
+                "Work-stealing pool", threads, expectedFib);
+        ThreadPool pinned(threads, true);
+        measure([&] { return fib<ThreadPool, TaskGroup>(pinned, FIB_N); },
+                "Work-stealing pool (pinned)", threads, expectedFib);
+    }
+
+    std::cout << "Parallel sum of " << SUM_SIZE << " values, grain " << SUM_GRAIN << "..." << std::endl;
+    for (size_t threads : threadCounts) {
+        SharedQueuePool shared(threads);
+        measure([&] { return parallelSum<SharedQueuePool, SharedQueueGroup>(shared, data.data(), data.size()); },
+                "Shared Queue pool", threads, expectedSum);
+        ThreadPool stealing(threads);
+        measure([&] { return parallelSum<ThreadPool, TaskGroup>(stealing, data.data(), data.size()); },
+                "Work-stealing pool", threads, expectedSum);
+        ThreadPool pinned(threads, true);
+        measure([&] { return parallelSum<ThreadPool, TaskGroup>(pinned, data.data(), data.size()); },
+                "Work-stealing pool (pinned)", threads, expectedSum);
+    }
+
+    return 0;
+}